@@ -4,8 +4,13 @@
 #include <deque>
 #include <set>
 #include <climits>      // LONG_MAX
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <memory>       // unique_ptr
 #include "lib/getoptions.hpp"
 #include "lib/Json.hpp"
+#include "lib/Inbuf.hpp"
 #include "lib/shell.hpp"
 #include "lib/dbg.hpp"
 
@@ -40,6 +45,7 @@ using namespace std;
 #define OPT_CMN x
 #define OPT_PRT y
 #define OPT_SZE z
+#define OPT_MEM Z
 
 // facilitate option materialization
 #define STR(X) XSTR(X)
@@ -51,6 +57,7 @@ using namespace std;
 #define CMP_BASE "json_1"
 #define CMP_COMP "json_2"
 #define SIZE_PFX "size: "
+#define MEM_PFX "footprint: "
 #define PATH_JSN "$PATH"                                        // token for JSON path interp.
 #define PATH_STR "$path"                                        // token for stringified path
 #define PATH_SPR "_"                                            // stringified path separtor
@@ -67,6 +74,10 @@ using namespace std;
         RC_END
 ENUM(ReturnCodes, RETURN_CODES)
 
+struct Abort {                                                  // processing aborted (failure
+    ReturnCodes         rc;                                     // is already reported)
+};
+
 // return code exception offsets
 #define OFF_GETOPT RC_END                                       // offset for Getopt exceptions
 #define OFF_JSON (OFF_GETOPT + Getopt::end_of_throw)            // offset for Json exceptions
@@ -99,22 +110,28 @@ class CommonResource {
     Getopt &            opt(void) { return opt_; };
     size_t              opt_e_found(void) { return opt_e_found_; }  // used for recompile once
     char                opt_ui(void){  return opt_ui_; };           // -i or -u for recompile
-    const string &      istr(void){  return istr_; };
+    const Inbuf &       ibuf(void){  return ib_; };
     Json &              json(void) { return gj_; };
 
     void                parse_opt(int argc, char *argv[]);
-    const string &      read_inputs(void);
+    const char *        read_inputs(void);
+    const char *        frame_json(const char * jsp, const char ** eoj = nullptr);
+    bool                more_inputs(const char * & jsp, const char ** eoj = nullptr);
+    size_t              workers(void);
+    size_t              cores(void) { return cores_; }
     void                jsonize(Json jout);
 
     DEBUGGABLE()
 
  private:
-    string              istr_;                                  // user intput string (json)
+    Inbuf               ib_;                                    // user input buffer (json)
     Getopt              opt_;
     size_t              opt_e_found_{0};                        // used for recompile once -e found
     char                opt_ui_{'\0'};                          // either -i or -u for recompile
     bool                ji_{false};                             // '-j' imposed?
     Json                gj_{ ARY{} };                           // global json
+    Symtab              gst_;                                   // labels of global json
+    size_t              cores_{max(thread::hardware_concurrency(), 1U)};  // queried once
 
     bool                is_recompile_required_(int argc, char *argv[]);
     void                recompile_args_(v_string &args, v_string &new_args);
@@ -158,23 +175,28 @@ class Jtc {
  public:
 
                         Jtc(void) = delete;
-                        Jtc(CommonResource & cr):
-                         cr_{cr}, opt_{cr.opt()} {
+                        Jtc(CommonResource & cr, ostream & out = cout, ostream & err = cerr):
+                         cr_{cr}, opt_{cr.opt()}, out_{out}, err_{err} {
                          ecli_ = opt_[CHR(OPT_EXE)].hits() > 0;     // flag used by -i/-u options
                          merge_ = opt_[CHR(OPT_MDF)].hits() > 0;    // flag used by -i/-u options
                          json_.tab(abs(opt_[CHR(OPT_IND)]))
                               .raw(opt_[CHR(OPT_RAW)])
-                              .quote_solidus(opt_[CHR(OPT_QUT)].hits() % 2 == 1);
-                        }
+                              .quote_solidus(opt_[CHR(OPT_QUT)].hits() % 2 == 1)
+                              .indexed()                        // input json: two-stage parsing
+                              .lazy(is_lazy_walk_());
+                         if(cr.workers() == 1 and opt_[CHR(OPT_DBG)].hits() == 0)
+                          json_.concurrent(cr.cores());         // unless jsons are processed
+                        }                                       // concurrently already
 
 
     // expose private objects
     auto &              opt(void) { return opt_; }
     auto &              json(void) { return json_; }
     auto &              jout(void) { return jout_; }
+    Jtc &               defer_jsonize(vector<Json> & jv) { jsz_ = &jv; return *this; }
 
     // user methods
-    void                parsejson(string::const_iterator & jsp);
+    void                parsejson(const char * & jsp);
     int                 write_json(Json & jsn, bool jsnize = true);
     int                 demux_opt(void);
     ReturnCodes         compare_jsons(void);
@@ -194,11 +216,14 @@ class Jtc {
     void                jsonized_output_obj_(Json::iterator &, size_t group, const Json &jref);
     void                console_output_(Json::iterator &, size_t group, const Json &jref);
     void                check_walk_requirements_(unsigned, WalkReq req=minimum);
+    bool                is_lazy_walk_(void);
+    bool                is_size_only_(void);
+    void                print_footprint_(const Jnode::Footprint & fp);
     void                crop_out_(void);
     bool                remove_others_(set<const Jnode*> &ws, Jnode &jn);
     walk_vec            collect_walks_(const string &walk_path);
-    void                compare_jsons_(const Jnode &, set<const Jnode*> &,
-                                       const Jnode &, set<const Jnode*> &);
+    void                compare_jsons_(Jnode &, set<const Jnode*> &,
+                                       Jnode &, set<const Jnode*> &);
     void                merge_jsons_(Json::iterator &dst, Json::iterator src);
     void                merge_into_array_(Jnode &dst, const Jnode &src, MergeObj mode);
     void                merge_into_object_(Jnode &dst, const Jnode &src, MergeObj mode);
@@ -219,10 +244,13 @@ class Jtc {
     void                process_offsets_(deque<walk_deq> &, vector<vector<long>> &,
                                          size_t, vector<size_t> &);
     size_t              build_front_grid_(vector<vector<long>> &, const deque<walk_deq> &);
-    void                location_(string::const_iterator & start);
+    void                location_(const char * start);
 
     CommonResource &    cr_;
     Getopt              opt_;
+    ostream &           out_;                                   // standard output (or captured)
+    ostream &           err_;                                   // standard error (or captured)
+    vector<Json> *      jsz_{nullptr};                          // deferred jsonization (-J)
     Json                json_;                                  // jtc input JSON
     map_json            jexc_;                                  // json for -ei or -eu
     Json                jout_;                                  // json output (-j)
@@ -239,7 +267,9 @@ class Jtc {
     size_t              key_{0};                                // for -i, -u options processing
     mptr                subscriber_;                            // method ptr for output processor
     Shell               sh_;
+    string              qb_;                                    // quotation buffer (-qq, -rr)
     ReturnCodes         cmp_{RC_OK};                            // for -c / compare return result
+    size_t              counted_{0};                            // json size, if only counted (-zz)
 
  public:
 
@@ -251,6 +281,7 @@ class Jtc {
 
 
 string quote_str(const string &src);
+void process_concurrently(CommonResource & cr, const char * jsp, int & main_rc);
 
 
 
@@ -290,6 +321,8 @@ int main(int argc, char *argv[]){
                         " must be given)");
  opt[CHR(OPT_SZE)].desc("print size (number of nodes in JSON) at the end of output (-"
                         STR(OPT_SZE) STR(OPT_SZE) " prints size only)");
+ opt[CHR(OPT_MEM)].desc("print memory footprint (bytes used by JSON) at the end of output (-"
+                        STR(OPT_MEM) STR(OPT_MEM) " prints footprint only)");
  opt[CHR(OPT_CMP)].desc("compare JSONs: display delta between given JSONs").name("f|j|w");
  opt[CHR(OPT_INS)].desc("insert/merge JSON, or from file, or pointed by a walk-path, see with -"
                         STR(OPT_GDE) " for more").name("f|j|w");
@@ -328,16 +361,19 @@ for a complete user guide visit https://github.com/ldn-softdev/jtc/blob/master/U
 
  // read json
  int main_rc = RC_OK;                                           // main's return code
- string::const_iterator jsp = cr.read_inputs().begin();         // global parse pointer
+ const char * jsp = cr.read_inputs();                           // global parse pointer
 
  // execute as per read options
  try {
-  do {
-   Jtc jtc(cr);
-   jtc.parsejson(jsp);
-   int rc = jtc.demux_opt();
-   main_rc = rc != RC_OK? rc: main_rc;
-  } while(*jsp != '\0' and opt[CHR(OPT_ALL)].hits() > 0);
+  if(cr.workers() > 1)                                          // -a: multiple jsons processed
+   process_concurrently(cr, jsp, main_rc);                      // concurrently
+  else
+   do {
+    Jtc jtc(cr);
+    jtc.parsejson(jsp);
+    int rc = jtc.demux_opt();
+    main_rc = rc != RC_OK? rc: main_rc;
+   } while(opt[CHR(OPT_ALL)].hits() > 0 and cr.more_inputs(jsp));
  }
  catch(Jnode::stdException & e) {
   DBG(1) DOUT() << "exception raised by: " << e.where() << endl;
@@ -353,6 +389,8 @@ for a complete user guide visit https://github.com/ldn-softdev/jtc/blob/master/U
   cerr << "regexp exception: " << e.what() << endl;
   main_rc = e.code() + OFF_REGEX;
  }
+ catch(Abort & e)                                               // no further processing
+  { return e.rc; }
 
  if(cr.json().empty()) return main_rc;
 
@@ -399,16 +437,89 @@ void CommonResource::parse_opt(int argc, char *argv[]) {
 
 
 
-const string & CommonResource::read_inputs(void) {
+const char * CommonResource::read_inputs(void) {
  bool read_from_cin{opt_[0].hits()==0 or opt_[CHR(OPT_RDT)].hits()>0};// no file, or forced via '-'
  DBG(0)
   DOUT() << "reading json from " << (read_from_cin? "<stdin>": opt_[0].c_str()) << endl;
 
- istr_ = string{istream_iterator<char>(read_from_cin?
-                                        cin >> noskipws:
-                                        ifstream{opt_[0].c_str(), ifstream::in} >> noskipws),
-                istream_iterator<char>{}};
- return istr_;
+ if(opt_[CHR(OPT_ALL)].hits() > 0) {                            // -a: read inputs incrementally
+  if(read_from_cin) ib_.stream();
+  else ib_.stream(opt_[0].str());
+  return frame_json(ib_.data());
+ }
+ if(read_from_cin) ib_.read();                                  // file is mapped, pipe is read
+ else ib_.read(opt_[0].str());                                  // by large blocks
+ DBG(1) DOUT() << "read " << ib_.size() << " bytes ("
+               << (ib_.is_mapped()? "mapped": "buffered") << ")" << endl;
+ return ib_.data();
+}
+
+
+
+const char * CommonResource::frame_json(const char * jsp, const char ** eoj) {
+ // when streaming, make sure the entire JSON at jsp is read in: release consumed input and
+ // read more until a trial (tree-less) parsing succeeds or fails for other reason than
+ // a lack of input. To keep it linear, a re-trial occurs only once the input has doubled.
+ // if eoj given, it's set to the end of the framed json (or to the end of the input,
+ // if the json is invalid)
+ #define LITERAL_LEN 5                                          // longest json literal: false
+ jsp = ib_.drop(jsp);
+ Json probe;
+ probe.indexed();
+ const char * pe{ib_.end()};                                    // probed end of json
+
+ for(size_t tried = 0; true;) {
+  bool eof = ib_.is_eof();
+  if(eof? eoj != nullptr: static_cast<size_t>(ib_.end() - jsp) >= 2 * tried) {
+   const char * pp = jsp;
+   try {
+    probe.parse(pp, Json::Events{}, Json::relaxed_no_trail);
+    if(eof or pp < ib_.end() or not isdigit(pp[-1]))            // a number might go on
+     { pe = pp; break; }
+   }
+   catch(Json::stdException & e) {                              // break, if not for a lack of
+    if(eof or probe.exception_pointer() + LITERAL_LEN < ib_.end()) break;  // input
+   }
+   tried = ib_.end() - jsp;
+  }
+  if(eof) break;
+  size_t offset = jsp - ib_.data();                             // fill() may relocate buffer
+  ib_.fill();
+  jsp = ib_.data() + offset;
+  pe = ib_.end();
+ }
+ #undef LITERAL_LEN
+
+ if(eoj != nullptr) *eoj = pe;
+ DBG(1) DOUT() << "framed json, buffered " << ib_.end() - jsp << " bytes" << endl;
+ return jsp;
+}
+
+
+
+bool CommonResource::more_inputs(const char * & jsp, const char ** eoj) {
+ // check if there's more json to process (skipping blanks), when streaming frame next json
+ while(true) {
+  while(*jsp > 0 and *jsp <= ' ') ++jsp;
+  if(*jsp != '\0' or ib_.is_eof()) break;
+  jsp = ib_.drop(jsp);
+  ib_.fill();
+  jsp = ib_.data();
+ }
+ if(*jsp == '\0') return false;
+ jsp = frame_json(jsp, eoj);
+ return true;
+}
+
+
+
+size_t CommonResource::workers(void) {
+ // number of threads to process multiple jsons (-a) concurrently: debugs, shell
+ // evaluations (-e) and overwriting the file (-f) require sequential processing
+ if(opt_[CHR(OPT_ALL)].hits() == 0 or opt_[CHR(OPT_DBG)].hits() > 0 or
+    opt_[CHR(OPT_EXE)].hits() > 0 or opt_[CHR(OPT_FRC)].hits() > 0)
+  return 1;
+ return cores_;
 }
 
 
@@ -425,13 +536,15 @@ bool CommonResource::is_recompile_required_(int argc, char *argv[]) {
 
 
 void CommonResource::jsonize(Json jout) {
- // put all walked and non-walked json results into a global json
+ // put all walked and non-walked json results into a global json: results are detached
+ // from their documents' trees, otherwise they would hold the arena of every document
+ Arena::Lasting scope;
  if(ji_ and jout.is_iterable()) {                               // -j was imposed
-  for(auto &jn: jout) gj_.push_back(move(jn));                  // therefore push one by one
+  for(auto &jn: jout) gj_.push_back(jn.detached(&gst_));        // therefore push one by one
   return;
  }
                                                                 // no -j were imposed:
- gj_.push_back(move(jout));                                     // move jout as it is
+ gj_.push_back(jout.root().detached(&gst_));                    // push jout as it is
 }
 
 
@@ -525,13 +638,126 @@ void CommonResource::convert_xyw_(void) {
 
 
 
+//
+// concurrent processing of multiple jsons (-a)
+//
+void process_concurrently(CommonResource & cr, const char * jsp, int & main_rc) {
+ // a pipeline: this thread frames input jsons and queues them to the worker threads, each
+ // worker processes a json with own Jtc instance capturing its outputs; outputs (and -J
+ // jsonizations) are released by the releasing thread strictly in the input order, as
+ // soon as they are ready (i.e. not held until a next json is read).
+ // An exception stops the pipeline and is re-thrown once all prior outputs are released
+ struct Jtask {
+     string             json;                                   // framed input json
+     stringstream       out, err;                               // captured outputs
+     vector<Json>       jsonized;                               // deferred -J jsonization
+     int                rc{RC_OK};
+     exception_ptr      exp;
+     bool               done{false};
+ };
+
+ size_t workers = cr.workers();
+ deque<unique_ptr<Jtask>> tasks;                                // in the input order
+ deque<Jtask*> queue;                                           // pending for workers
+ mutex mtx;
+ condition_variable queued, done, released;
+ bool closing{false}, read{false};                              // read: all inputs are queued
+ exception_ptr failed;                                          // exception of released task
+
+ auto worker = [&](void) {
+  while(true) {
+   Jtask * t;
+   {
+    unique_lock<mutex> lck(mtx);
+    queued.wait(lck, [&]{ return closing or not queue.empty(); });
+    if(queue.empty()) return;
+    t = queue.front();
+    queue.pop_front();
+   }
+   try {
+    Jtc jtc(cr, t->out, t->err);
+    const char * tjsp = t->json.c_str();
+    jtc.defer_jsonize(t->jsonized).parsejson(tjsp);
+    t->rc = jtc.demux_opt();
+   }
+   catch(...) { t->exp = current_exception(); }
+   { lock_guard<mutex> lck(mtx); t->done = true; }
+   done.notify_all();
+  }
+ };
+
+ auto releaser = [&](void) {                                    // release tasks in order
+  while(true) {
+   Jtask * t;
+   {
+    unique_lock<mutex> lck(mtx);
+    done.wait(lck, [&]{ return tasks.empty()? read: tasks.front()->done; });
+    if(tasks.empty()) return;
+    t = tasks.front().get();                                    // (only releaser pops tasks)
+   }
+   cout << t->out.str() << flush;
+   cerr << t->err.str() << flush;
+   for(auto & jsn: t->jsonized) cr.jsonize(move(jsn));
+   main_rc = t->rc != RC_OK? t->rc: main_rc;
+   exception_ptr exp = t->exp;
+   {
+    lock_guard<mutex> lck(mtx);
+    tasks.pop_front();
+    failed = exp;
+   }
+   released.notify_all();
+   if(exp) return;
+  }
+ };
+
+ vector<thread> pool;
+ for(size_t i = 0; i < workers; ++i) pool.emplace_back(worker);
+ thread output(releaser);
+
+ exception_ptr rexp;                                            // exception of reading
+ try {
+  const char * eoj;
+  if(not cr.more_inputs(jsp, &eoj))                             // no json at all: let parser
+   { Jtc jtc(cr); jtc.parsejson(jsp); }                         // throw
+  for(bool more = true; more; more = cr.more_inputs(jsp, &eoj)) {
+   unique_ptr<Jtask> t{new Jtask};
+   t->json.assign(jsp, eoj);
+   jsp = eoj;
+   {
+    unique_lock<mutex> lck(mtx);                                // bound memory
+    released.wait(lck, [&]{ return failed or tasks.size() < workers * 4; });
+    if(failed) break;
+    queue.push_back(t.get());
+    tasks.push_back(move(t));
+   }
+   queued.notify_one();
+  }
+ }
+ catch(...) { rexp = current_exception(); }
+
+ { lock_guard<mutex> lck(mtx); read = true; }
+ done.notify_all();
+ output.join();                                                 // all prior outputs released
+ { lock_guard<mutex> lck(mtx); closing = true; queue.clear(); }
+ queued.notify_all();
+ for(auto & th: pool) th.join();
+
+ if(failed) rethrow_exception(failed);
+ if(rexp) rethrow_exception(rexp);
+}
+
+
+
 //
 // Jtc methods definitions
 //
-void Jtc::parsejson(string::const_iterator & jsp) {
- // parse read json text via string iterator
- string::const_iterator jbegin = jsp;                           // for debug / location_ only
- try { json_.parse(jsp); }
+void Jtc::parsejson(const char * & jsp) {
+ // parse read json text via (NUL terminated) char pointer
+ const char * jbegin = jsp;                                     // for debug / location_ only
+ try {
+  if(is_size_only_()) counted_ = json_.count(jsp);              // no tree is built then
+  else json_.parse(jsp);
+ }
  catch(Json::stdException & e) {
   if(e.code() >= Jnode::start_of_json_parsing_exceptions and
      e.code() <= Jnode::end_of_json_parsing_exceptions)
@@ -551,7 +777,9 @@ int Jtc::write_json(Json & json, bool jsonize) {
  // write whole json to output (demultiplexing file and stdout), featuring:
  // inquoting/unquoting json string, putting array into json (-j), printing size to stdout
  if(opt_[CHR(OPT_SZE)].hits() > 1)                              // -zz
-  { cout << json.size() << endl; return RC_OK; }
+  { out_ << (counted_ > 0? counted_: json.size()) << endl; return RC_OK; }
+ if(opt_[CHR(OPT_MEM)].hits() > 1)                              // -ZZ
+  { out_ << json.footprint().total() << endl; return RC_OK; }
 
  bool write_to_file{opt_[0].hits() > 0 and opt_[CHR(OPT_FRC)].hits() > 0};  // [0] and -f given
  bool unquote{opt_[CHR(OPT_QUT)].hits() >= 2};                  // -qq given, unquote
@@ -561,22 +789,28 @@ int Jtc::write_json(Json & json, bool jsonize) {
   json = ARY{ move(json) };
 
  if(not unquote and inquote)
-  json.root() = json.inquote_str(json.to_string(Jnode::Raw));
+  json.root() = json.inquote_str(json.to_string(Jnode::Raw), qb_);
  DBG(0)
   DOUT() << "outputting json to " << (write_to_file?
                                        opt_[0].c_str():
                                        opt_[CHR(OPT_JSN)]? "<JSON>": "<stdout>") << endl;
- if(opt_[CHR(OPT_JAL)].hits() > 0)                              // -J, jsonize to global
-  { cr_.jsonize(move(json)); return RC_OK; }
+ if(opt_[CHR(OPT_JAL)].hits() > 0) {                            // -J, jsonize to global
+  if(jsz_ != nullptr) jsz_->push_back(move(json));              // or defer it (when concurrent)
+  else cr_.jsonize(move(json));
+  return RC_OK;
+ }
 
- ofstream fout{write_to_file? opt_[0].c_str(): nullptr};
- ostream & xout = write_to_file? fout: cout;
+ ofstream fout;
+ if(write_to_file) fout.open(opt_[0].c_str());
+ ostream & xout = write_to_file? fout: out_;
 
- if(unquote and json.is_string()) xout << json.unquote_str(json.str()) << endl;
+ if(unquote and json.is_string()) xout << json.unquote_str(json.str(), qb_) << endl;
  else xout << json << endl;
 
  if(opt_[CHR(OPT_SZE)])
-  cout << SIZE_PFX << json.size() << endl;
+  out_ << SIZE_PFX << json.size() << endl;
+ if(opt_[CHR(OPT_MEM)])
+  print_footprint_(json.footprint());
 
  return RC_OK;
 }
@@ -722,7 +956,7 @@ void Jtc::insert_by_iterator(Json::iterator &it, size_t group) {
 
   bool is_cli_success{true};
   if(jsrc_.empty() and not isrc_[key_].is_valid())              // key is in isrc_ and invalid
-   cerr << "error: walk instance " << key_
+   err_ << "error: walk instance " << key_
         << " became invalid due to prior operations, skipping" << endl;
   else {
    if(ecli_) {
@@ -757,7 +991,7 @@ void Jtc::purge_json(void) {
    if(ji[i].is_valid()) {                                      // i.e. hasn't been deleted already
     DBG(1) DOUT() << "purging walk instance " << i << endl;
     if(rec.is_root()) rec.clear();                             // if root, erase everything
-    else rec[-1].erase(ji[i]);
+    else { ji[i].json().clear_cache(ji[i]); rec[-1].erase(ji[i]); } // via parent's Jnode &
    }
   }
  }
@@ -814,7 +1048,7 @@ void Jtc::update_by_iterator(Json::iterator &it, size_t group) {
   lbl_update_ = not it.walks().empty() and it.walks().back().jsearch == Json::key_of_value;
  else                                                           // lbl update occurred, then
   if(not it.is_valid())                                         // verify sanity of dst walks
-   { cerr << "error: destination walk became invalid, skipping update" << endl; return; }
+   { err_ << "error: destination walk became invalid, skipping update" << endl; return; }
  if(processed_by_cli_(it)) return;                              // -e w/o trailing -u processed
 
  size_t max_key = not jsrc_.empty()? jsrc_.size(): isrc_.size();
@@ -823,7 +1057,7 @@ void Jtc::update_by_iterator(Json::iterator &it, size_t group) {
 
   bool is_cli_success{true};
   if(jsrc_.empty() and not isrc_[key_].is_valid())              // it's isrc source and key invalid
-   cerr << "error: walk instance " << key_
+   err_ << "error: walk instance " << key_
         << " became invalid due to prior operations, skipping" << endl;
   else {                                                        // isrc_ is valid, or jsrc[key_]
    if(ecli_) {                                                  // -e with trailing -u
@@ -855,7 +1089,7 @@ int Jtc::swap_json(void) {
  size_t max_i = min(swaps[0].size(), swaps[1].size());
  for(size_t i = 0; i < max_i; ++i) {                            // swap only paired walks
   if(not swaps[0][i].is_valid() or not swaps[1][i].is_valid()) {
-   cerr << "fail: walk instance " << i
+   err_ << "fail: walk instance " << i
         << " became invalid due to prior operations, aborting" << endl;
    return RC_WP_INV;
   }
@@ -923,7 +1157,8 @@ void Jtc::jsonized_output_ary_(Json::iterator &wi, size_t group, const Json &jtm
  // if -j option given, output into jout_ as Array
  auto create_obj = [&]{ return opt_[CHR(OPT_SEQ)].hits() > 0?
                                group >= last_group_: group > last_group_; };
- auto &sr = jtmp_ref.type() == Jnode::Neither? *wi: jtmp_ref.root();
+ const auto &sr = jtmp_ref.type() == Jnode::Neither?
+                  *wi: Json::iterator::SuperJnode{jtmp_ref.root()};
  if(not opt_[CHR(OPT_LBL)])                                     // -l not given, make simple array
   { jout_.push_back(sr); return; }
                                                                 // -l given (combine relevant grp)
@@ -953,7 +1188,8 @@ void Jtc::jsonized_output_ary_(Json::iterator &wi, size_t group, const Json &jtm
 
 void Jtc::jsonized_output_obj_(Json::iterator &wi, size_t group, const Json &jtmp_ref) {
  // if -jj option given, output into jout_ as Object (items w/o label are ignored)
- auto &sr = jtmp_ref.type() == Jnode::Neither? *wi: jtmp_ref.root();
+ const auto &sr = jtmp_ref.type() == Jnode::Neither?
+                  *wi: Json::iterator::SuperJnode{jtmp_ref.root()};
 
  if(not sr.has_label()) return;                                 // sr has no label, ignore
 
@@ -973,23 +1209,28 @@ void Jtc::jsonized_output_obj_(Json::iterator &wi, size_t group, const Json &jtm
 void Jtc::console_output_(Json::iterator &wi, size_t group, const Json &jtmp_ref) {
  // no -j given, print out element pointed by iter wi
  if(opt_[CHR(OPT_SZE)].hits() > 1)
-  { cout << wi->size() << endl; return; }
+  { out_ << wi->size() << endl; return; }
+ if(opt_[CHR(OPT_MEM)].hits() > 1)
+  { out_ << wi->footprint().total() << endl; return; }
 
- auto &sr = jtmp_ref.type() == Jnode::Neither? *wi: jtmp_ref.root();
+ const auto &sr = jtmp_ref.type() == Jnode::Neither?
+                  *wi: Json::iterator::SuperJnode{jtmp_ref.root()};
  bool unquote{opt_[CHR(OPT_QUT)].hits() >= 2};                  // -qq given
  bool inquote{opt_[CHR(OPT_RAW)].hits() >= 2};                  // -rr given, inquote
 
  if(opt_[CHR(OPT_LBL)] and sr.has_label())                      // -l given
-  { cout << '"' << sr.label() << "\": ";  unquote = false; }    // then print label (if present)
+  { out_ << '"' << sr.label() << "\": ";  unquote = false; }    // then print label (if present)
  if(unquote and sr.is_string())
-  cout << json_.unquote_str(sr.str()) << endl;                  // don't try collapsing it into
+  out_ << json_.unquote_str(sr.str(), qb_) << endl;             // don't try collapsing it into
  else {
-  if(inquote) cout << '"' << json_.inquote_str(sr.to_string(Jnode::Raw)) << '"' << endl;
-  else cout << sr << endl;                                      // a single operation!
+  if(inquote) out_ << '"' << json_.inquote_str(sr.to_string(Jnode::Raw), qb_) << '"' << endl;
+  else out_ << sr << endl;                                      // a single operation!
  }
 
  if(opt_[CHR(OPT_SZE)])                                         // -z given
-  cout << SIZE_PFX << sr.size() << endl;
+  out_ << SIZE_PFX << sr.size() << endl;
+ if(opt_[CHR(OPT_MEM)])                                         // -Z given
+  print_footprint_(sr.footprint());
 }
 
 
@@ -998,15 +1239,50 @@ void Jtc::console_output_(Json::iterator &wi, size_t group, const Json &jtmp_ref
 // private methods
 //
 void Jtc::check_walk_requirements_(unsigned x, WalkReq req) {
- // check if actual number of walks fits min requirements
+ // check if actual number of walks fits min requirements (walks of an atomic json are
+ // reset, so the failure is json's one: it's reported in order with other outputs)
  if(req == exact)
   { if(opt_[CHR(OPT_WLK)].hits() == x) return; }
  else
   { if(opt_[CHR(OPT_WLK)].hits() >= x) return; }
 
- cerr << "fail: " << (req==exact? "exactly ":"at least ") << x << " '-" STR(OPT_WLK)
+ err_ << "fail: " << (req==exact? "exactly ":"at least ") << x << " '-" STR(OPT_WLK)
          "' must be given" << endl;
- exit(RC_WLK_MISS);
+ throw Abort{RC_WLK_MISS};
+}
+
+
+
+bool Jtc::is_lazy_walk_(void) {
+ // lazy parsing pays off only if walks address a part of json directly, i.e. no search
+ // lexemes (traversing json recursively) and no modifications (output entire json);
+ // footprint (-Z) is of the parsed tree (not of deferred raw text)
+ if(opt_[CHR(OPT_WLK)].hits() == 0) return false;
+ for(char opt: STR(OPT_CMP)STR(OPT_INS)STR(OPT_UPD)STR(OPT_SWP)STR(OPT_PRG)STR(OPT_MEM))
+  if(opt != '\0' and opt_[opt].hits() > 0) return false;
+ for(auto & wp: opt_[CHR(OPT_WLK)])
+  if(wp.find_first_of("<>") != string::npos) return false;
+ return true;
+}
+
+
+
+bool Jtc::is_size_only_(void) {
+ // -zz w/o walks and modifications requires only validating and counting of input json
+ if(opt_[CHR(OPT_SZE)].hits() < 2) return false;
+ for(char opt: STR(OPT_CMP)STR(OPT_INS)STR(OPT_UPD)STR(OPT_SWP)STR(OPT_PRG)STR(OPT_WLK))
+  if(opt != '\0' and opt_[opt].hits() > 0) return false;
+ return true;
+}
+
+
+
+void Jtc::print_footprint_(const Jnode::Footprint & fp) {
+ // print memory used (bytes) in total and by its parts (cache and namespace are of entire
+ // JSON only, walked elements have none)
+ out_ << MEM_PFX << fp.total() << " (nodes: " << fp.nodes << ", strings: " << fp.strings
+      << ", containers: " << fp.containers << ", cache: " << fp.cache << ", namespace: "
+      << fp.ns << ")" << endl;
 }
 
 
@@ -1021,13 +1297,14 @@ void Jtc::crop_out_(void) {
 
  DBG(0) DOUT() << "preserved instances: " << preserve.size() << endl;
  remove_others_(preserve, json_.root());
+ json_.clear_cache();                                           // json modified via Jnode &
 }
 
 
 bool Jtc::remove_others_(set<const Jnode*> &ws, Jnode &jn) {
  // return true if node has to be removed. remove all but those in ws
  bool remove = true;
- if(ws.count(&jn.value())) return false;                        // preserve root itself if found
+ if(ws.count(&jn)) return false;                                // preserve root itself if found
 
  for(auto it = jn.begin(); it != jn.end();) {
   if(it->is_atomic()) {
@@ -1069,9 +1346,10 @@ Jtc::walk_vec Jtc::collect_walks_(const string &walk_path) {
 
 
 
-void Jtc::compare_jsons_(const Jnode &j1, set<const Jnode*> &s1,
-                         const Jnode &j2, set<const Jnode*> &s2) {
+void Jtc::compare_jsons_(Jnode &j1, set<const Jnode*> &s1, Jnode &j2, set<const Jnode*> &s2) {
  // compare j1 <> j2, put into s1 and j2 nodes which are different (require preserving)
+ // nodes are accessed mutably: children shared with the source jsons get copied then,
+ // so that addresses of the nodes stay put (for remove_others_)
  if(j1.type() != j2.type()) {
   s1.insert(&j1);
   s2.insert(&j2);
@@ -1112,7 +1390,8 @@ void Jtc::compare_jsons_(const Jnode &j1, set<const Jnode*> &s1,
 void Jtc::merge_jsons_(Json::iterator &it_dst, Json::iterator it_src) {
  // merge 2 jsons. convert to array non-array dst jsons (predicated by -m)
  if(it_dst.walks().back().jsearch == Json::key_of_value)        // '<>k' facing
-  { cerr << "error: insert into label not applicable, use update" << endl; return; }
+  { err_ << "error: insert into label not applicable, use update" << endl; return; }
+ it_dst.json().clear_cache(it_dst);                             // dst merged via Jnode &
 
  if(it_dst->is_object()) {                                      // dst is object
   if(it_src->has_label())                                       // it's coming from -i walk-path
@@ -1121,7 +1400,7 @@ void Jtc::merge_jsons_(Json::iterator &it_dst, Json::iterator it_src) {
    if(it_src->is_iterable())                                    // from either json/walk-path
     merge_into_object_(*it_dst, *it_src, preserve);
    else
-    cerr << "error: only an iterable could be insert-merged with an object" << endl;
+    err_ << "error: only an iterable could be insert-merged with an object" << endl;
   return;
  }
 
@@ -1132,10 +1411,10 @@ void Jtc::merge_jsons_(Json::iterator &it_dst, Json::iterator it_src) {
  }
 
  if(it_dst->is_array()) {                                       // merge only 1 json object
-  it_dst->push_back(it_src->has_label()? OBJ{ LBL{it_src->label(), *it_src} }: *it_src);
+  it_dst->push_back(it_src->has_label()? OBJ{ LBL{it_src->label(), *it_src} }: it_src->value());
   return;
  }
- cerr << "error: walk-path must point to an iterable, or use merging" << endl;
+ err_ << "error: walk-path must point to an iterable, or use merging" << endl;
 }
 
 
@@ -1210,15 +1489,16 @@ void Jtc::merge_into_object_(Jnode &dst, const Jnode &src, MergeObj mode) {
 
 void Jtc::update_jsons_(Json::iterator &it_dst, Json::iterator it_src) {
  // update dst with src, merge jsons with overwrite if -m is given
+ it_dst.json().clear_cache(it_dst);                             // dst updated via Jnode &
  if(it_dst.walks().back().jsearch == Json::key_of_value) {      // facilitate '<>k'
   DBG(2) DOUT() << "label being updated" << endl;
   if(merge_)
-   { cerr << "error: merge not applicable in label update, ignoring" << endl; }
+   { err_ << "error: merge not applicable in label update, ignoring" << endl; }
   if(not it_src->is_string())
-   { cerr << "error: only labels could be updated with valid JSON strings" << endl; return; }
+   { err_ << "error: only labels could be updated with valid JSON strings" << endl; return; }
   auto & parent = (*it_dst)[-1];
   if(not parent.is_object())
-   { cerr << "error: labels could be updated in objects only" << endl; return; }
+   { err_ << "error: labels could be updated in objects only" << endl; return; }
   if(*it_src == *it_dst) return;                                // do not move then
   parent[it_src->str()] = move(parent[it_dst->str()]);
   parent.erase(it_dst->str());
@@ -1234,12 +1514,12 @@ void Jtc::update_jsons_(Json::iterator &it_dst, Json::iterator it_src) {
  DBG(2) DOUT() << "destination being merged" << endl;
  if(it_dst->is_object())
   merge_into_object_(*it_dst, it_src->has_label()?
-                              OBJ{ LBL{ it_src->label(), *it_src } }: *it_src, overwrite);
+                              OBJ{ LBL{ it_src->label(), *it_src } }: it_src->value(), overwrite);
  else
   if(it_dst->is_array())
    merge_into_array_(*it_dst, *it_src, overwrite);
   else
-   *it_dst = it_src->has_label()? OBJ{ LBL{ it_src->label(), *it_src } }: *it_src;
+   *it_dst = it_src->has_label()? OBJ{ LBL{ it_src->label(), *it_src } }: it_src->value();
 }
 
 
@@ -1263,16 +1543,14 @@ bool Jtc::execute_cli_(Json &json, Json::iterator &jit, const Json::map_jn &ns)
  // execute cli in -i/u option (interpolating jit if required) and parse the result into json
  sh_.system( reconcile_ui_(jit, ns) );
  if(sh_.rc() != 0)
-  { cerr << "error: shell returned error (" << sh_.rc() << ")" << endl; return false; }
+  { err_ << "error: shell returned error (" << sh_.rc() << ")" << endl; return false; }
  if(sh_.stdout().empty())
   { DBG(1) DOUT() << "shell returned empty result, not updating" << endl; return false; }
 
  DBG().severity(json);
  try { json.parse(sh_.stdout()); }
  catch(Json::stdException & e) {                                // promote output to JSON string
-  string out = json.inquote_str(sh_.stdout());                  // inquote all occurrences of ["\]
-  out = regex_replace(out, regex{R"(\r)"}, R"(\r)");
-  out = regex_replace(out, regex{R"(\n)"}, R"(\n)");
+  string out = json.inquote_str(sh_.stdout());                  // inquote ["\] and control chars
   if(out.compare(out.size()-2, 2, R"(\n)") == 0)                // erase possibly trailing \n
    out.erase(out.size()-2);
   json.parse("\"" + out + "\"");
@@ -1314,12 +1592,12 @@ void Jtc::parse_params_(char option) {
  else
   for(auto & arg: opt_[option])
    try {
-    string jstr{istream_iterator<char>(ifstream{arg, ifstream::in} >> noskipws),
-               istream_iterator<char>{}};
+    Inbuf ib;
+    ib.read(arg);
     DBG().severity(jsrc_[jsrc_.size()]);
     DBG(1) DOUT() << "attempting to parse parameter (" << arg << ") as json" << endl;
-    jsrc_[jsrc_.size()-1].parse(jstr.empty()? arg: jstr,
-                                jstr.empty()? Json::strict_no_trail: Json::strict_trailing);
+    if(ib.empty()) jsrc_[jsrc_.size()-1].parse(arg, Json::strict_no_trail);
+    else jsrc_[jsrc_.size()-1].parse(ib.data(), Json::strict_trailing);
     if(not jexc_.empty()) { jsrc_.erase(jsrc_.size()-1); continue; }
    }
    catch(Json::stdException & e) {                              // not a static json - a walk-path
@@ -1376,12 +1654,12 @@ void Jtc::build_path_(Jnode &jpath, Json::iterator &jit) {
 
  for(auto &itr: jit.path())
   if(node->is_array()) {
-   long idx = strtol(itr.lbl.c_str(), nullptr, 16);
+   long idx = itr.idx;
    jpath.push_back(idx);
    node = &(*node)[idx];
   }
   else {
-   jpath.push_back(itr.lbl);
+   jpath.push_back(itr.lbl.str());
    node = &(*node)[itr.lbl];
   }
 }
@@ -1438,7 +1716,7 @@ string Jtc::interpolate_tmp_(const string &tmp, const Json::map_jn &ns) {
 
  while(not head.empty()) {
   for(const auto & ins: ns) {
-   string sk = head.back() + ins.KEY + tail.back();         // sk: search key
+   string sk = head.back() + ins.KEY.str() + tail.back();   // sk: search key
    string sv = ins.VALUE.to_string(Jnode::Raw);             // sv: json string (literal) value
    if(head.back().size() == 1)                              // i.e. {} interpolation
     if(sv.front() == '"') sv = sv.substr(1, sv.size()-2);   // drop quotes in string
@@ -1592,15 +1870,15 @@ size_t Jtc::build_front_grid_(vector<vector<long>> &fom, const deque<walk_deq> &
 
 
 
-void Jtc::location_(string::const_iterator &jbegin) {
+void Jtc::location_(const char * jbegin) {
  // show location of the exception, unicode UTF-8 supported
- string jsrc{&*jbegin};
+ string jsrc{jbegin};
  const char * pfx = "exception locus: ";
  for(auto &chr: jsrc)
   chr = chr AMONG('\r', '\n')? '|': static_cast<unsigned char>(chr) < ' '? ' ': chr;
 
- size_t from_start = Json::utf8_adjusted(0, jsrc, json_.exception_point() - jbegin);
- size_t to_end = Json::utf8_adjusted(json_.exception_point() - jbegin, jsrc);
+ size_t from_start = Json::utf8_adjusted(0, jsrc, json_.exception_pointer() - jbegin);
+ size_t to_end = Json::utf8_adjusted(json_.exception_pointer() - jbegin, jsrc);
  size_t ptr = from_start;
 
  if(from_start + to_end > DBG_WIDTH) {
@@ -0,0 +1,219 @@
+/*
+ * region (arena) allocation for JSON trees
+ *
+ * memory is carved out of large chunks by bumping a pointer, a deallocation of a block
+ * merely counts down live blocks of its chunk; once a chunk is retired (i.e. it's not
+ * bumped from anymore) and has no live blocks left, it's released as a whole. Released
+ * chunks are kept (up to ARN_KEEP) for reuse, thus a next tree (e.g. a next JSON from
+ * a stream) is built in the memory of the previous one
+ *
+ *  - every thread bumps its own chunk (no locking), while blocks could be freed by any
+ *    thread (live counts are atomic): trees could be built by one thread, moved around
+ *    (spliced into other trees) and destroyed by another
+ *  - the chunk of a block is found by masking block's address: chunks are aligned by
+ *    their size
+ *  - until a chunk is retired, its live count is biased by ARN_BIAS (the owning thread
+ *    does not maintain the count when bumping and settles it upon retirement)
+ *  - a chunk is released only when all of its blocks are freed, so a few long living
+ *    blocks among short living ones would hold their chunks: blocks outliving the trees
+ *    (e.g. results accumulated over a stream of JSONs) must be allocated within a scope
+ *    of Arena::Lasting - then thread's blocks are bumped from chunks of their own
+ *
+ * SYNOPSIS:
+ *  typedef std::pair<const std::string, int> pair_si;
+ *  std::map<std::string, int, std::less<std::string>, Arena::Alloc<pair_si>> m;
+ *  {
+ *   Arena::Lasting scope;
+ *   m["kept"] = 1;                     // the node is bumped from lasting chunks
+ *  }
+ */
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <new>                  // std::bad_alloc
+#include <sys/mman.h>           // mmap, munmap
+
+
+#define ARN_CHUNK (256 * 1024)                                  // chunk size (and alignment)
+#define ARN_MAXB (ARN_CHUNK / 16)                               // larger blocks are not pooled
+#define ARN_KEEP 64                                             // released chunks kept for reuse
+#define ARN_BIAS (SIZE_MAX / 2)                                 // live count bias of a bumped chunk
+
+
+
+
+
+class Arena {
+ public:
+    template<typename T>
+    class Alloc;
+    class Lasting;
+
+    static void *       allocate(size_t size, size_t align);
+    static void         deallocate(void * ptr);
+
+ private:
+    struct Chunk {
+        std::atomic<size_t> live;                               // count of live blocks
+    };
+
+    struct Bump {                                               // thread's current chunk
+                       ~Bump(void) { retire(); }
+        void            retire(void);
+
+        Chunk *         chunk{nullptr};
+        char *          top{nullptr};                           // next free byte
+        size_t          blocks{0};                              // blocks allocated in chunk
+    };
+
+    struct Depot {                                              // released chunks
+        std::mutex      mtx;
+        std::vector<Chunk *>
+                        chunks;
+    };
+
+    struct Bumps {                                              // thread's chunks:
+        Bump            tree;                                   // - of trees (default)
+        Bump            lasting;                                // - of blocks outliving trees
+        Bump *          current{&tree};
+    };
+
+    static Bumps &      bumps_(void)
+                         { static thread_local Bumps bumps; return bumps; }
+    static Depot &      depot_(void)                            // never destroyed: blocks could
+                         { static Depot & depot = *new Depot; return depot; } // outlive statics
+    static Chunk *      acquire_(void);
+    static void         release_(Chunk * chunk);
+};
+
+
+
+class Arena::Lasting {
+ // scope of thread's allocations outliving trees (scopes could be nested)
+ public:
+                        Lasting(void): prev_{bumps_().current}
+                         { bumps_().current = &bumps_().lasting; }
+                       ~Lasting(void) { bumps_().current = prev_; }
+                        Lasting(const Lasting &) = delete;
+    Lasting &           operator=(const Lasting &) = delete;
+
+ private:
+    Bump *              prev_;
+};
+
+
+
+template<typename T>
+class Arena::Alloc {
+ // stateless allocator facade (all instances are equal)
+ public:
+    typedef T value_type;
+
+                        Alloc(void) = default;
+    template<typename U>
+                        Alloc(const Alloc<U> &) {}
+
+    T *                 allocate(size_t n) {
+                         size_t size = n * sizeof(T);
+                         return static_cast<T*>(size > ARN_MAXB?
+                                                ::operator new(size):
+                                                Arena::allocate(size, alignof(T)));
+                        }
+    void                deallocate(T * ptr, size_t n) {
+                         if(n * sizeof(T) > ARN_MAXB) ::operator delete(ptr);
+                         else Arena::deallocate(ptr);
+                        }
+
+    template<typename U>
+    bool                operator==(const Alloc<U> &) const { return true; }
+    template<typename U>
+    bool                operator!=(const Alloc<U> &) const { return false; }
+};
+
+
+
+void * Arena::allocate(size_t size, size_t align) {
+ // bump a block from thread's chunk, acquire a new chunk if the current one is exhausted
+ Bump & b = *bumps_().current;
+ char * ptr = b.top + (-reinterpret_cast<uintptr_t>(b.top) & (align - 1));
+ if(b.chunk == nullptr or ptr + size > reinterpret_cast<char*>(b.chunk) + ARN_CHUNK) {
+  b.retire();
+  b.chunk = acquire_();
+  b.top = reinterpret_cast<char*>(b.chunk + 1);
+  ptr = b.top + (-reinterpret_cast<uintptr_t>(b.top) & (align - 1));
+ }
+ b.top = ptr + size;
+ ++b.blocks;
+ return ptr;
+}
+
+
+
+void Arena::deallocate(void * ptr) {
+ // count down live blocks of the chunk, release the chunk with the last one
+ Chunk * chunk = reinterpret_cast<Chunk*>(reinterpret_cast<uintptr_t>(ptr) & ~(ARN_CHUNK - 1));
+ if(chunk->live.fetch_sub(1, std::memory_order_acq_rel) == 1)
+  release_(chunk);
+}
+
+
+
+void Arena::Bump::retire(void) {
+ // stop bumping the chunk: settle its live count
+ if(chunk == nullptr) return;
+ size_t settle = ARN_BIAS - blocks;
+ if(chunk->live.fetch_sub(settle, std::memory_order_acq_rel) == settle)
+  release_(chunk);
+ chunk = nullptr;
+ top = nullptr;
+ blocks = 0;
+}
+
+
+
+Arena::Chunk * Arena::acquire_(void) {
+ // get a chunk from depot, or allocate a new one
+ Chunk * chunk{nullptr};
+ Depot & d = depot_();
+ {
+  std::lock_guard<std::mutex> lock(d.mtx);
+  if(not d.chunks.empty())
+   { chunk = d.chunks.back(); d.chunks.pop_back(); }
+ }
+ if(chunk == nullptr) {                                        // map twice the size, then trim
+  void * mem = mmap(nullptr, 2 * ARN_CHUNK, PROT_READ | PROT_WRITE,   // it to an aligned chunk
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if(mem == MAP_FAILED) throw std::bad_alloc();
+  char * map = static_cast<char*>(mem);
+  char * beg = map + (-reinterpret_cast<uintptr_t>(map) & (ARN_CHUNK - 1));
+  if(beg > map) munmap(map, beg - map);
+  munmap(beg + ARN_CHUNK, map + ARN_CHUNK - beg);
+  chunk = new(beg) Chunk;
+ }
+ chunk->live.store(ARN_BIAS, std::memory_order_relaxed);
+ return chunk;
+}
+
+
+
+void Arena::release_(Chunk * chunk) {
+ // return a chunk to depot (or unmap it if depot is full)
+ Depot & d = depot_();
+ {
+  std::lock_guard<std::mutex> lock(d.mtx);
+  if(d.chunks.size() < ARN_KEEP)
+   { d.chunks.push_back(chunk); return; }
+ }
+ chunk->~Chunk();
+ munmap(chunk, ARN_CHUNK);
+}
+
+#undef ARN_CHUNK
+#undef ARN_MAXB
+#undef ARN_KEEP
+#undef ARN_BIAS
+
@@ -0,0 +1,597 @@
+/*
+ * container of JSON iterable's children (descendants)
+ *
+ * Descendants keeps children of either iterable kind in a vector of slots, a slot holds
+ * a child in a pair (along with child's label) and child's position in the vector:
+ *  - labeled children (object's) are kept sorted by labels: a label is looked up by a
+ *    binary search in O(log n), an insertion (or removal) of a child is O(n), though
+ *    it's merely a shift of pointers
+ *  - indexed children (array's) have a null symbol for a label
+ * children of either kind are addressed by position in O(1), appending is amortized O(1)
+ *
+ * a container becomes indexed or labeled with its first child: append(v) appends an
+ * indexed child, emplace(l, v) inserts a labeled one. Labeled children could be appended
+ * too (e.g. by parser), append(l, v), then the container must be sort()'ed once all are
+ * appended: of children with a same label only the first one stays (like with emplace)
+ *
+ * iterators of both kinds are bidirectional and alike: an iterator stays valid (just
+ * like map's does) until its child is erased, i.e. insertion, or removal of other
+ * children does not invalidate it (though may shift child's position). End iterator
+ * belongs to the container (not to its content, which could be swapped away). Slots
+ * (and the vector itself) are allocated from the arena (see "Arena.hpp")
+ *
+ * copies of a container share its children (copy-on-write), i.e. copying is O(1): a
+ * shared container copies its children upon a first non-const access (a single level,
+ * grandchildren get shared in turn). Handing out mutable iterators (references) to
+ * children must be followed by pin(): pinned children are never shared (a copy copies
+ * them right away), otherwise a change via such iterator would show in the copies too.
+ * Sharing is not atomic: containers sharing children must be used by a single thread
+ * at a time
+ *
+ * a container could keep a hash and a total of its children (computed by the container's
+ * user, e.g. a structural hash of a JSON iterable and a count of its nodes): any non-const
+ * access drops them. A pinned container keeps neither (its children could be changed via
+ * handed out iterators)
+ *
+ * a pinned container has an epoch (unique among all containers), which is renewed
+ * whenever a child is removed: an iterator (of a pinned container) kept along with the
+ * epoch is surely valid if the container still holds() it
+ *
+ * SYNOPSIS:
+ *  Descendants<Jnode> d;
+ *  d.append(NUM{1}); d.append(NUM{2});
+ *  std::cout << d.nth(1)->second << ", " << d.nth(1).index() << std::endl; // prints 2, 1
+ */
+
+#pragma once
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <cstdint>
+#include <iterator>
+#include <algorithm>            // std::lower_bound, std::stable_sort
+#include <stdexcept>            // std::out_of_range
+#include <utility>              // std::pair, std::forward
+#include <type_traits>          // std::remove_const, std::enable_if
+#include "Arena.hpp"
+#include "Symtab.hpp"
+
+
+
+
+
+template<typename N>
+class Descendants {
+ public:
+    typedef std::pair<const Symbol, N> value_type;
+
+    template<typename P>
+    class Iter;
+    typedef Iter<value_type> iterator;
+    typedef Iter<const value_type> const_iterator;
+    typedef std::reverse_iterator<iterator> reverse_iterator;
+    typedef std::reverse_iterator<const_iterator> const_reverse_iterator;
+
+  friend void           swap(Descendants & l, Descendants & r) {
+                         std::swap(l.sv_, r.sv_);
+                         if(l.sv_ != nullptr) l.sv_->owner = &l;
+                         if(r.sv_ != nullptr) r.sv_->owner = &r;
+                        }
+
+                        Descendants(void) = default;            // DC
+                        Descendants(const Descendants & d);     // CC
+                        Descendants(Descendants && d)           // MC
+                         { swap(*this, d); }
+                       ~Descendants(void);
+    Descendants &       operator=(Descendants d)                // CA, MA
+                         { swap(*this, d); return *this; }
+
+    bool                is_indexed(void) const { return sv_ != nullptr and sv_->indexed; }
+    size_t              size(void) const { return sv_ == nullptr? 0: sv_->vec.size(); }
+    bool                empty(void) const { return size() == 0; }
+    void                clear(void);
+
+                        // sharing of children
+    bool                is_shared(void) const { return sv_ != nullptr and sv_->refs > 1; }
+    const void *        identity(void) const { return sv_; }    // of children (alike if shared)
+    size_t              footprint(void) const;                  // container's overhead (bytes)
+    Descendants &       own(void);                              // copy children, if shared
+    Descendants &       pin(void);                              // own and never share children
+    static void         pin(const iterator & it)                // pin container of the iterator
+                         { if(it.sv_ != nullptr) pin_(it.sv_); }
+
+                        // validation of kept iterators (see epoch)
+    static uint64_t     epoch(const iterator & it)
+                         { return it.sv_ == nullptr? 0: it.sv_->epoch; }
+    bool                holds(const iterator & it, uint64_t epoch) const
+                         { return sv_ == it.sv_ and epoch != 0 and sv_->epoch == epoch; }
+
+                        // cached hash of children
+    bool                cached_hash(size_t & h) const {
+                         if(sv_ == nullptr or not sv_->hashed) return false;
+                         h = sv_->hash;
+                         return true;
+                        }
+    void                cache_hash(size_t h) const {
+                         if(sv_ == nullptr or sv_->pinned) return;
+                         sv_->hash = h;
+                         sv_->hashed = true;
+                        }
+
+                        // cached total of children (e.g. of their subtrees sizes)
+    bool                cached_total(size_t & t) const {
+                         if(sv_ == nullptr or not sv_->totaled) return false;
+                         t = sv_->total;
+                         return true;
+                        }
+    void                cache_total(size_t t) const {
+                         if(sv_ == nullptr or sv_->pinned) return;
+                         sv_->total = t;
+                         sv_->totaled = true;
+                        }
+
+    iterator            begin(void)
+                         { own(); return {sv_, empty()? nullptr: sv_->vec.front(), this}; }
+    const_iterator      begin(void) const
+                         { return {sv_, empty()? nullptr: sv_->vec.front(), this}; }
+    const_iterator      cbegin(void) const { return begin(); }
+    iterator            end(void) { own(); return {sv_, nullptr, this}; }
+    const_iterator      end(void) const { return {sv_, nullptr, this}; }
+    const_iterator      cend(void) const { return end(); }
+    reverse_iterator    rbegin(void) { return reverse_iterator{end()}; }
+    const_reverse_iterator
+                        rbegin(void) const { return const_reverse_iterator{end()}; }
+    reverse_iterator    rend(void) { return reverse_iterator{begin()}; }
+    const_reverse_iterator
+                        rend(void) const { return const_reverse_iterator{begin()}; }
+
+                        // labeled children
+    iterator            find(const std::string & l)
+                         { own(); size_t pos = find_(l); return pos == size()? end(): nth(pos); }
+    const_iterator      find(const std::string & l) const
+                         { size_t pos = find_(l); return pos == size()? end(): nth(pos); }
+    size_t              count(const std::string & l) const
+                         { return find_(l) == size()? 0: 1; }
+    N &                 operator[](const std::string & l)
+                         { return emplace(Symbol{l}, N{}).first->second; }
+    N &                 at(const std::string & l);
+    const N &           at(const std::string & l) const;
+    template<typename V>
+    std::pair<iterator, bool>
+                        emplace(Symbol && l, V && v);
+    size_t              erase(const std::string & l);
+    template<typename V>
+    iterator            append(Symbol && l, V && v);            // must be sort()'ed after
+    void                sort(void);
+
+                        // indexed children
+    template<typename V>
+    iterator            append(V && v);
+
+                        // either
+    iterator            nth(size_t idx)                         // idx must be within size()
+                         { own(); return {sv_, sv_->vec[idx], this}; }
+    const_iterator      nth(size_t idx) const
+                         { return {sv_, sv_->vec[idx], this}; }
+    iterator            erase(iterator it);
+
+    bool                operator==(const Descendants & d) const;
+    bool                operator!=(const Descendants & d) const { return not operator==(d); }
+
+ private:
+    struct Slot {
+        template<typename V>
+                        Slot(Symbol && l, V && v, size_t p):
+                         kv{std::move(l), std::forward<V>(v)}, pos{p} {}
+
+        value_type      kv;                                     // label is null, if indexed
+        size_t          pos;                                    // position in the vector
+    };
+    struct Slots {
+        std::vector<Slot *, Arena::Alloc<Slot *>>
+                        vec;
+        size_t          refs;                                   // containers sharing slots
+        size_t          hash;                                   // cached hash (if hashed)
+        size_t          total;                                  // cached total (if totaled)
+        uint64_t        epoch;                                  // of pinned slots (see holds())
+        bool            indexed;                                // kind of children
+        bool            pinned;                                 // never shared (see pin())
+        bool            hashed;
+        bool            totaled;
+        Descendants *   owner;                                  // container (for end iterator)
+    };
+
+    size_t              lower_bound_(const std::string & l) const;
+    size_t              find_(const std::string & l) const;
+    template<typename V>
+    iterator            insert_(size_t pos, Symbol && l, V && v);
+    void                renumber_(size_t from);
+    void                make_slots_(bool indexed);
+    void                slots_(bool indexed);
+    void                copy_(const Descendants & d);
+    void                release_(void);
+    void                removed_(void)                          // a child was removed
+                         { if(sv_->epoch != 0) sv_->epoch = next_epoch_(); }
+    static void         pin_(Slots * sv) {                      // (pinned keeps no hash, total)
+                         if(not sv->pinned) sv->hashed = sv->totaled = false;
+                         sv->pinned = true;
+                         if(sv->epoch == 0) sv->epoch = next_epoch_();
+                        }
+    static uint64_t     next_epoch_(void);
+
+    void                changed_(void)                          // children inserted, erased
+                         { sv_->totaled = false; }
+
+    template<typename T, typename... Args>
+    static T *          make_(Args &&... args);
+    template<typename T>
+    static void         free_(T * ptr);
+
+    Slots *             sv_{nullptr};                           // children
+};
+
+
+
+template<typename N>
+template<typename P>
+class Descendants<N>::Iter: public std::iterator<std::bidirectional_iterator_tag,
+                                                 typename std::remove_const<P>::type,
+                                                 ptrdiff_t, P *, P &> {
+ // points to child's slot, end iterator (null slot) tells its container instead
+    friend Descendants;
+    template<typename> friend class Iter;
+
+ public:
+                        Iter(void) = default;                   // null (singular) iterator
+                        template<typename Q, typename =         // iterator -> const_iterator
+                                 typename std::enable_if<std::is_same<const Q, P>::value>::type>
+                        Iter(const Iter<Q> & it): sv_{it.sv_}, sp_{it.sp_}, dp_{it.dp_} {}
+
+    P &                 operator*(void) const { return sp_->kv; }
+    P *                 operator->(void) const { return &sp_->kv; }
+    Iter &              operator++(void) {
+                         if(sp_->pos + 1 < sv_->vec.size()) sp_ = sv_->vec[sp_->pos + 1];
+                         else {                                 // container of shared slots
+                          sp_ = nullptr;                        // is ambiguous: keep own one
+                          if(sv_->refs == 1 and sv_->owner != nullptr) dp_ = sv_->owner;
+                         }
+                         return *this;
+                        }
+    Iter &              operator--(void) {
+                         sp_ = sv_->vec[sp_ == nullptr? sv_->vec.size() - 1: sp_->pos - 1];
+                         return *this;
+                        }
+    Iter                operator++(int) { auto tmp{*this}; ++(*this); return tmp; }
+    Iter                operator--(int) { auto tmp{*this}; --(*this); return tmp; }
+
+    template<typename Q>
+    bool                operator==(const Iter<Q> & it) const
+                         { return sp_ == it.sp_ and (sp_ != nullptr or dp_ == it.dp_); }
+    template<typename Q>
+    bool                operator!=(const Iter<Q> & it) const { return not operator==(it); }
+
+    bool                is_indexed(void) const { return sv_->indexed; }
+    size_t              index(void) const { return sp_->pos; }  // child's position
+
+ private:
+                        Iter(Slots * sv, Slot * sp, const Descendants * dp):
+                         sv_{sv}, sp_{sp}, dp_{dp} {}
+
+    Slots *             sv_{nullptr};
+    Slot *              sp_{nullptr};                           // child (null, if end)
+    const Descendants * dp_{nullptr};                           // container (of end)
+};
+
+
+
+template<typename N>
+Descendants<N>::Descendants(const Descendants & d) {
+ // children are shared, unless pinned (then copied)
+ if(d.sv_ == nullptr) return;
+ if(d.sv_->pinned)
+  { copy_(d); return; }
+ sv_ = d.sv_;
+ ++sv_->refs;
+}
+
+
+
+template<typename N>
+Descendants<N>::~Descendants(void) {
+ release_();
+}
+
+
+
+template<typename N>
+void Descendants<N>::clear(void) {
+ // container remains of its kind
+ if(sv_ == nullptr) return;
+ if(sv_->refs > 1) {                                            // shared: leave them be
+  bool indexed = sv_->indexed;
+  release_();
+  return make_slots_(indexed);
+ }
+ for(auto sp: sv_->vec)
+  free_(sp);
+ sv_->vec.clear();
+ sv_->hashed = sv_->totaled = false;
+ removed_();
+}
+
+
+
+template<typename N>
+size_t Descendants<N>::footprint(void) const {
+ // memory used by the container itself: slots (w/o children, labels' strings) and vector
+ if(sv_ == nullptr) return 0;
+ return sizeof(Slots) + sv_->vec.capacity() * sizeof(Slot *) +
+        sv_->vec.size() * (sizeof(Slot) - sizeof(N));
+}
+
+
+
+template<typename N>
+Descendants<N> & Descendants<N>::own(void) {
+ // a shared container gets own copy of children, cached hash and total are dropped
+ // (children are about to be changed, possibly)
+ if(sv_ == nullptr) return *this;
+ if(sv_->refs > 1) {
+  Descendants tmp;
+  tmp.copy_(*this);
+  swap(*this, tmp);
+ }
+ sv_->hashed = sv_->totaled = false;
+ return *this;
+}
+
+
+
+template<typename N>
+Descendants<N> & Descendants<N>::pin(void) {
+ // own children and never share them (even an empty container gets its slots)
+ own();
+ if(sv_ == nullptr) make_slots_(false);
+ pin_(sv_);
+ return *this;
+}
+
+
+
+template<typename N>
+N & Descendants<N>::at(const std::string & l) {
+ own();
+ size_t pos = find_(l);
+ if(pos == size()) throw std::out_of_range("Descendants::at");
+ return sv_->vec[pos]->kv.second;
+}
+
+
+
+template<typename N>
+const N & Descendants<N>::at(const std::string & l) const {
+ size_t pos = find_(l);
+ if(pos == size()) throw std::out_of_range("Descendants::at");
+ return sv_->vec[pos]->kv.second;
+}
+
+
+
+template<typename N>
+template<typename V>
+std::pair<typename Descendants<N>::iterator, bool> Descendants<N>::emplace(Symbol && l, V && v) {
+ // insert a labeled child into its sorted position, unless label exists already
+ slots_(false);
+ size_t pos = lower_bound_(l);
+ if(pos < size() and sv_->vec[pos]->kv.first == l) return {nth(pos), false};
+ return {insert_(pos, std::move(l), std::forward<V>(v)), true};
+}
+
+
+
+template<typename N>
+size_t Descendants<N>::erase(const std::string & l) {
+ own();
+ size_t pos = find_(l);
+ if(pos == size()) return 0;
+ erase(nth(pos));
+ return 1;
+}
+
+
+
+template<typename N>
+template<typename V>
+typename Descendants<N>::iterator Descendants<N>::append(Symbol && l, V && v) {
+ // append a labeled child (unsorted)
+ slots_(false);
+ return insert_(size(), std::move(l), std::forward<V>(v));
+}
+
+
+
+template<typename N>
+void Descendants<N>::sort(void) {
+ // sort appended labeled children, drop duplicate labels (first one stays)
+ if(size() < 2) return;
+ own();
+ auto & vec = sv_->vec;
+ size_t i = 1;
+ while(i < vec.size() and vec[i - 1]->kv.first < vec[i]->kv.first) ++i;
+ if(i == vec.size()) return;                                    // sorted already (typical)
+ changed_();
+
+ std::stable_sort(vec.begin(), vec.end(),
+                  [](const Slot * l, const Slot * r) { return l->kv.first < r->kv.first; });
+ size_t n = 1;
+ for(i = 1; i < vec.size(); ++i)
+  if(vec[i]->kv.first == vec[n - 1]->kv.first) free_(vec[i]);
+  else vec[n++] = vec[i];
+ vec.resize(n);
+ renumber_(0);
+ removed_();
+}
+
+
+
+template<typename N>
+template<typename V>
+typename Descendants<N>::iterator Descendants<N>::append(V && v) {
+ // append an indexed child
+ slots_(true);
+ return insert_(size(), Symbol{nullptr}, std::forward<V>(v));
+}
+
+
+
+template<typename N>
+typename Descendants<N>::iterator Descendants<N>::erase(iterator it) {
+ // erase a child, return iterator to the next one
+ size_t pos = it.sp_->pos;                                      // (it may point to shared slots)
+ own();
+ changed_();
+ auto & vec = sv_->vec;
+ free_(vec[pos]);
+ vec.erase(vec.begin() + pos);
+ renumber_(pos);                                                // following ones shift forward
+ removed_();
+ return pos < vec.size()? nth(pos): end();
+}
+
+
+
+template<typename N>
+bool Descendants<N>::operator==(const Descendants & d) const {
+ // labels of indexed children are not compared (null symbols)
+ if(size() != d.size()) return false;
+ if(empty()) return true;
+ if(sv_->indexed != d.sv_->indexed) return false;
+ for(size_t i = 0; i < size(); ++i) {
+  auto & l = sv_->vec[i]->kv, & r = d.sv_->vec[i]->kv;
+  if(not sv_->indexed and l.first != r.first) return false;
+  if(l.second != r.second) return false;
+ }
+ return true;
+}
+
+
+
+template<typename N>
+size_t Descendants<N>::lower_bound_(const std::string & l) const {
+ // position of the first label not less than l (or size())
+ return std::lower_bound(sv_->vec.begin(), sv_->vec.end(), l,
+                         [](const Slot * sp, const std::string & l) { return sp->kv.first < l; })
+        - sv_->vec.begin();
+}
+
+
+
+template<typename N>
+size_t Descendants<N>::find_(const std::string & l) const {
+ // position of a labeled child (size(), if none)
+ if(sv_ == nullptr or sv_->indexed) return size();
+ size_t pos = lower_bound_(l);
+ if(pos < size() and sv_->vec[pos]->kv.first != l) return size();
+ return pos;
+}
+
+
+
+template<typename N>
+template<typename V>
+typename Descendants<N>::iterator Descendants<N>::insert_(size_t pos, Symbol && l, V && v) {
+ // insert a new slot at the position (shifting following ones)
+ auto & vec = sv_->vec;
+ Slot * sp = make_<Slot>(std::move(l), std::forward<V>(v), pos);
+ try { vec.insert(vec.begin() + pos, sp); }
+ catch(...) { free_(sp); throw; }
+ changed_();
+ renumber_(pos + 1);
+ return {sv_, sp, this};
+}
+
+
+
+template<typename N>
+void Descendants<N>::renumber_(size_t from) {
+ for(size_t i = from; i < sv_->vec.size(); ++i)
+  sv_->vec[i]->pos = i;
+}
+
+
+
+template<typename N>
+void Descendants<N>::make_slots_(bool indexed) {
+ sv_ = make_<Slots>();
+ sv_->refs = 1;
+ sv_->indexed = indexed;
+ sv_->owner = this;
+}
+
+
+
+template<typename N>
+void Descendants<N>::slots_(bool indexed) {
+ // prepare own slots for an insertion: an empty container takes the kind of a child
+ if(sv_ == nullptr) return make_slots_(indexed);
+ own();
+ if(empty()) sv_->indexed = indexed;
+}
+
+
+
+template<typename N>
+void Descendants<N>::copy_(const Descendants & d) {
+ // copy children into this (empty) container: a single level, grandchildren are shared
+ Descendants tmp;
+ tmp.make_slots_(d.sv_->indexed);
+ tmp.sv_->vec.reserve(d.size());
+ for(auto sp: d.sv_->vec)
+  tmp.insert_(tmp.size(), Symbol{sp->kv.first}, sp->kv.second);
+ swap(*this, tmp);
+}
+
+
+
+template<typename N>
+void Descendants<N>::release_(void) {
+ // drop a reference to the slots, free them with the last one
+ if(sv_ == nullptr) return;
+ if(--sv_->refs == 0) {
+  for(auto sp: sv_->vec)
+   free_(sp);
+  free_(sv_);
+ }
+ else
+  if(sv_->owner == this) sv_->owner = nullptr;                  // survivors do not know it
+ sv_ = nullptr;
+}
+
+
+
+template<typename N>
+template<typename T, typename... Args>
+T * Descendants<N>::make_(Args &&... args) {
+ void * mem = Arena::allocate(sizeof(T), alignof(T));
+ try { return new(mem) T{std::forward<Args>(args)...}; }
+ catch(...) { Arena::deallocate(mem); throw; }
+}
+
+
+
+template<typename N>
+template<typename T>
+void Descendants<N>::free_(T * ptr) {
+ ptr->~T();
+ Arena::deallocate(ptr);
+}
+
+
+
+template<typename N>
+uint64_t Descendants<N>::next_epoch_(void) {
+ // epochs are unique: slots reallocated at a same address never take an old epoch
+ static std::atomic<uint64_t> epoch{0};
+ return epoch.fetch_add(1, std::memory_order_relaxed) + 1;
+}
@@ -0,0 +1,425 @@
+/*
+ * decimal text <-> binary number conversions
+ *
+ * parse() converts a JSON number into either an exact int64 (when the number is an
+ * integral value fitting int64), or into a correctly rounded double:
+ *  - Clinger's fast path is tried first (mantissa <= 2^53, |exponent| <= 22)
+ *  - then Eisel-Lemire algorithm: the mantissa (up to 19 digits) is multiplied by a
+ *    128-bit truncated power of 5, the result is exact unless the product falls right
+ *    at the rounding boundary
+ *  - all other (rare) cases are passed to strtod(), as well as a text not conforming
+ *    JSON number definition (e.g. "inf", "nan")
+ *
+ * format() prints a double as the shortest decimal which parses back into the same double
+ * (of equally short ones - the closest to the double). Schubfach algorithm: the value and
+ * the boundaries of its rounding interval are scaled by a 128-bit power of 10 rounded to
+ * odd, which is exact enough to tell whether a shorter decimal lies within the interval.
+ * The layout is the one of "%.15g": the scientific notation is used only for exponents
+ * < -4 or >= 15
+ *
+ * tables of 128-bit powers of 5 (truncated, for parsing) and of 10 (rounded up, for
+ * formatting) are computed once, upon a first use
+ *
+ * SYNOPSIS:
+ *  double d;
+ *  int64_t i;
+ *  if(Fpconv::parse("12345", d, i))
+ *   std::cout << "integer: " << i << std::endl;
+ *  else
+ *   std::cout << "double: " << d << std::endl;
+ *
+ *  std::string s;
+ *  std::cout << Fpconv::format(0.1 + 0.2, s) << std::endl;     // prints 0.30000000000000004
+ *
+ * both directions have also char buffer versions: parse(begin, end, ...) does not read
+ * past the end, format(x, buf) prints a double (or an int64) into Fpconv::Buf (w/o a
+ * terminating NUL) and returns the printed length
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <cstdlib>              // strtod
+#include <cstring>              // memcpy
+#include <cmath>                // signbit, isnan, isinf
+
+
+#define FPC_MINP (-325)                                         // range of tabulated powers of 5
+#define FPC_MAXP 326                                            // (formatting needs up to 10^325)
+#define FPC_MAXD 19                                             // max digits in uint64 mantissa
+#define FPC_FIXD 15                                             // max exponent of a fixed notation
+#define FPC_BUFS 32                                             // min buffer size for format()
+
+
+
+
+
+class Fpconv {
+ public:
+    typedef char Buf[FPC_BUFS];                                 // buffer for format()
+
+    static bool         parse(const std::string & s, double & d, int64_t & i)
+                         { return parse(s.data(), s.data() + s.size(), d, i); }
+    static bool         parse(const char * b, const char * e, double & d, int64_t & i);
+    static std::string &
+                        format(double x, std::string & s);
+    static size_t       format(double x, Buf & buf) { return print_(x, buf); }
+    static size_t       format(int64_t i, Buf & buf);
+
+ private:
+    struct Pow {                                                // 128-bit power (of 5 or 10)
+        uint64_t            hi;                                 // top 64 bits (normalized)
+        uint64_t            lo;                                 // next 64 bits
+    };
+    struct Tables {
+        std::vector<Pow>    pow5;                               // truncated
+        std::vector<Pow>    pow10;                              // rounded up
+    };
+
+    static bool         fast_path_(int64_t q, uint64_t w, bool neg, double & d);
+    static size_t       print_(double x, char * buf);
+    static int          schubfach_(double x, char * dg, int & len);
+    static uint64_t     round_odd_(const Pow & g, uint64_t cp);
+    static uint64_t     mul_(uint64_t x, uint64_t y, uint64_t & lo);
+    static const std::vector<Pow> &
+                        pow5_(void) { return tables_().pow5; }
+    static const std::vector<Pow> &
+                        pow10_(void) { return tables_().pow10; }
+    static const Tables &
+                        tables_(void);
+};
+
+
+
+bool Fpconv::parse(const char * b, const char * e, double & d, int64_t & i) {
+ // convert decimal number in [b, e): return true if it's an exact int64 (then i is set),
+ // otherwise d is set
+ const char * p = b;
+ auto at = [&p, e](char c) { return p < e and *p == c; };
+ auto digit = [&p, e](void) { return p < e and static_cast<unsigned>(*p - '0') < 10; };
+ auto slow_path = [b, e, &d](void) { d = strtod(std::string{b, e}.c_str(), nullptr); return false; };
+
+ bool neg = at('-');
+ if(neg) ++p;
+ uint64_t w{0};                                                 // decimal mantissa
+ const char * mp = p;                                           // mantissa's beginning
+ for(; digit(); ++p) w = 10 * w + (*p - '0');
+ int64_t nd = p - mp;                                           // number of mantissa digits
+ int64_t q{0};                                                  // decimal exponent
+ if(at('.')) {
+  const char * fp = ++p;
+  for(; digit(); ++p) w = 10 * w + (*p - '0');
+  q = fp - p;
+  nd -= q;
+ }
+ if(nd == 0) return slow_path();
+ if(at('e') or at('E')) {
+  ++p;
+  bool eneg = at('-');
+  if(eneg or at('+')) ++p;
+  if(not digit()) return slow_path();
+  int64_t x{0};
+  for(; digit(); ++p)
+   if(x < 100000) x = 10 * x + (*p - '0');                      // (avoid overflow)
+  q += eneg? -x: x;
+ }
+ if(p != e) return slow_path();                                 // not a JSON number
+
+ if(nd > FPC_MAXD) {                                            // leading zeros aren't significant
+  for(const char * c = mp; c < p and (*c == '0' or *c == '.'); ++c)
+   if(*c == '0') --nd;
+  if(nd > FPC_MAXD) return slow_path();                         // mantissa overflows uint64
+ }
+ if(w == 0) {
+  if(neg) { d = -0.0; return false; }
+  i = 0;
+  return true;
+ }
+
+ for(; q < 0 and w % 10 == 0; ++q) w /= 10;                     // drop trailing fraction zeros
+ if(q >= 0 and q <= FPC_MAXD) {                                 // could be an integral
+  uint64_t v{w};
+  bool ovf{false};
+  for(int64_t k = 0; k < q and not ovf; ++k)
+   ovf = __builtin_mul_overflow(v, 10, &v);
+  if(not ovf and v <= (neg? 1ULL << 63: (1ULL << 63) - 1))
+   { i = neg? static_cast<int64_t>(0 - v): static_cast<int64_t>(v); return true; }
+ }
+
+ if(fast_path_(q, w, neg, d)) return false;
+ return slow_path();
+}
+
+
+
+bool Fpconv::fast_path_(int64_t q, uint64_t w, bool neg, double & d) {
+ // convert w * 10^q into double (w != 0), return false if a slow path is required
+ static const double p10[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                              1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21,
+                              1e22};
+ if(q >= -22 and q <= 22 and w <= 1ULL << 53) {                 // Clinger: exact operands
+  d = static_cast<double>(w);
+  d = q < 0? d / p10[-q]: d * p10[q];
+  if(neg) d = -d;
+  return true;
+ }
+
+ #ifdef __SIZEOF_INT128__
+  typedef unsigned __int128 uint128_t;
+  if(q < FPC_MINP or q > FPC_MAXP) return false;
+  const Pow & p5 = pow5_()[q - FPC_MINP];
+  int64_t exponent = (((152170 + 65536) * q) >> 16) + 1024 + 63;  // floor(log2(10^q)) + bias
+  int lz = __builtin_clzll(w);
+  w <<= lz;
+  uint128_t product = static_cast<uint128_t>(w) * p5.hi;
+  uint64_t lower = product, upper = product >> 64;
+  if((upper & 0x1FF) == 0x1FF and lower + w < lower) {          // truncated p5.hi is inexact
+   uint128_t product2 = static_cast<uint128_t>(w) * p5.lo;
+   uint64_t middle = lower + static_cast<uint64_t>(product2 >> 64);
+   if(middle < lower) ++upper;
+   if(middle + 1 == 0 and (upper & 0x1FF) == 0x1FF and
+      static_cast<uint64_t>(product2) + w < static_cast<uint64_t>(product2))
+    return false;                                               // still ambiguous
+   lower = middle;
+  }
+  uint64_t upperbit = upper >> 63;
+  uint64_t mantissa = upper >> (upperbit + 9);
+  lz += 1 ^ upperbit;
+  if(lower == 0 and (upper & 0x1FF) == 0 and (mantissa & 3) == 1)
+   return false;                                                // exactly halfway: ties
+  mantissa += mantissa & 1;                                     // round
+  mantissa >>= 1;
+  if(mantissa >= 1ULL << 53)                                    // rounding overflowed
+   { mantissa = 1ULL << 52; --lz; }
+  mantissa &= ~(1ULL << 52);
+  int64_t real_exponent = exponent - lz;
+  if(real_exponent < 1 or real_exponent > 2046)                 // subnormal or infinite
+   return false;
+  mantissa |= static_cast<uint64_t>(real_exponent) << 52;
+  mantissa |= static_cast<uint64_t>(neg) << 63;
+  std::memcpy(&d, &mantissa, sizeof(d));
+  return true;
+ #else
+  return false;
+ #endif
+}
+
+
+
+std::string & Fpconv::format(double x, std::string & s) {
+ // print x into s (w/o any stream), return s
+ Buf buf;                                                       // "-d.ddddddddddddddddde-308"
+ return s.assign(buf, print_(x, buf));
+}
+
+
+
+size_t Fpconv::format(int64_t i, Buf & buf) {
+ // print i into buf, return printed length
+ char dg[20];
+ int len{0};
+ uint64_t v = i < 0? 0 - static_cast<uint64_t>(i): i;
+ do { dg[len++] = '0' + v % 10; v /= 10; } while(v > 0);
+ char * p = buf;
+ if(i < 0) *p++ = '-';
+ while(len > 0) *p++ = dg[--len];
+ return p - buf;
+}
+
+
+
+size_t Fpconv::print_(double x, char * buf) {
+ // print x into buf as a shortest round-trip decimal, return printed length
+ char * p = buf;
+ if(std::signbit(x)) { *p++ = '-'; x = -x; }
+ if(std::isnan(x)) { std::memcpy(p, "nan", 3); return p + 3 - buf; }
+ if(std::isinf(x)) { std::memcpy(p, "inf", 3); return p + 3 - buf; }
+ if(x == 0) { *p++ = '0'; return p - buf; }
+
+ char dg[20];                                                   // x = dg[0..len) * 10^e
+ int len{0};
+ int e = schubfach_(x, dg, len);
+ int xp = len + e - 1;                                          // exponent of d.ddd notation
+ if(xp < -4 or xp >= FPC_FIXD) {                                // scientific: d[.ddd]e[+-]dd[d]
+  *p++ = dg[0];
+  if(len > 1)
+   { *p++ = '.'; std::memcpy(p, dg + 1, len - 1); p += len - 1; }
+  *p++ = 'e';
+  *p++ = xp < 0? '-': '+';
+  if(xp < 0) xp = -xp;
+  if(xp >= 100) *p++ = '0' + xp / 100;
+  *p++ = '0' + xp / 10 % 10;
+  *p++ = '0' + xp % 10;
+ }
+ else if(e >= 0) {                                              // integral: ddd000
+  std::memcpy(p, dg, len); p += len;
+  std::memset(p, '0', e); p += e;
+ }
+ else if(xp >= 0) {                                             // ddd.ddd
+  std::memcpy(p, dg, xp + 1); p += xp + 1;
+  *p++ = '.';
+  std::memcpy(p, dg + xp + 1, len - xp - 1); p += len - xp - 1;
+ }
+ else {                                                         // 0.000ddd
+  *p++ = '0'; *p++ = '.';
+  std::memset(p, '0', -xp - 1); p += -xp - 1;
+  std::memcpy(p, dg, len); p += len;
+ }
+ return p - buf;
+}
+
+
+
+int Fpconv::schubfach_(double x, char * dg, int & len) {
+ // generate shortest digits of x (finite, > 0) into dg, return decimal exponent:
+ // x = c * 2^q, any decimal within its rounding interval parses back into x; the value
+ // and the boundaries are scaled by 4 * 10^-k (k = floor(log10(2^q))), so that
+ // the interval is narrower than 40 units: it holds at most one multiple of 40 (a decimal
+ // one digit shorter), otherwise the value is rounded to the closest unit
+ uint64_t bits;
+ std::memcpy(&bits, &x, sizeof(bits));
+ uint64_t bf = bits & ((1ULL << 52) - 1);
+ int be = bits >> 52;
+ uint64_t c = be == 0? bf: bf | 1ULL << 52;
+ int q = be == 0? 1 - 1075: be - 1075;
+
+ uint64_t d;                                                    // x = d * 10^k
+ int k{0};
+ if(be != 0 and q <= 0 and q > -53 and (c & ((1ULL << -q) - 1)) == 0)
+  d = c >> -q;                                                  // integral: exact
+ else {
+  bool even = c % 2 == 0;                                       // boundaries belong to x
+  bool closer = bf == 0 and be > 1;                             // lower boundary is closer
+  k = (q * 1262611 - (closer? 524031: 0)) >> 22;                // floor(log10([3/4] 2^q))
+  int h = q + ((-k * 1741647) >> 19) + 1;                       // floor(log2(10^-k)): 1..4
+  const Pow & g = pow10_()[-k - FPC_MINP];
+  uint64_t vbl = round_odd_(g, (4 * c - 2 + closer) << h);
+  uint64_t vb = round_odd_(g, 4 * c << h);
+  uint64_t vbr = round_odd_(g, (4 * c + 2) << h);
+  uint64_t lower = vbl + not even, upper = vbr - not even;
+
+  uint64_t s = vb / 4, sp = s / 10 * 10;                        // s <= x < s + 1 (scaled)
+  bool u_in = lower <= 4 * sp, w_in = 4 * sp + 40 <= upper;
+  if(s >= 10 and u_in != w_in)                                  // a shorter one is within
+   d = w_in? sp + 10: sp;
+  else {
+   u_in = lower <= 4 * s;
+   w_in = 4 * s + 4 <= upper;
+   if(u_in != w_in)
+    d = w_in? s + 1: s;
+   else                                                         // both: the closest one (even)
+    d = vb > 4 * s + 2 or (vb == 4 * s + 2 and s % 2 == 1)? s + 1: s;
+  }
+ }
+
+ for(; d % 10 == 0; d /= 10) ++k;                               // drop trailing zeros
+ char tmp[20];
+ int n{0};
+ for(; d > 0; d /= 10) tmp[n++] = '0' + d % 10;
+ while(n > 0) dg[len++] = tmp[--n];
+ return k;
+}
+
+
+
+uint64_t Fpconv::round_odd_(const Pow & g, uint64_t cp) {
+ // top 64 bits of 192-bit product g * cp, rounded to odd (g is rounded up, hence the
+ // product is exact if the lower 64 bits are 0 or 1)
+ uint64_t xl, yl;
+ uint64_t xh = mul_(g.lo, cp, xl);
+ uint64_t yh = mul_(g.hi, cp, yl);
+ uint64_t z = yl + xh;
+ if(z < yl) ++yh;
+ return yh | (z > 1);
+}
+
+
+
+uint64_t Fpconv::mul_(uint64_t x, uint64_t y, uint64_t & lo) {
+ // 128-bit product: return upper half, lower one into lo
+ #ifdef __SIZEOF_INT128__
+  unsigned __int128 p = static_cast<unsigned __int128>(x) * y;
+  lo = p;
+  return p >> 64;
+ #else
+  uint64_t a = x >> 32, b = x & 0xFFFFFFFF, c = y >> 32, d = y & 0xFFFFFFFF;
+  uint64_t ac = a * c, bc = b * c, ad = a * d, bd = b * d;
+  uint64_t mid = (bd >> 32) + (ad & 0xFFFFFFFF) + (bc & 0xFFFFFFFF);
+  lo = (mid << 32) | (bd & 0xFFFFFFFF);
+  return ac + (ad >> 32) + (bc >> 32) + (mid >> 32);
+ #endif
+}
+
+
+
+const Fpconv::Tables & Fpconv::tables_(void) {
+ // 128-bit normalized powers of 5 and 10 for [FPC_MINP, FPC_MAXP]: built with a trivial
+ // big-number arithmetic (vectors of 32-bit words, little endian)
+ static const Tables tbl = [](void) {
+  typedef std::vector<uint32_t> bignum;
+  auto bitlen = [](const bignum & n) {
+   for(int k = n.size() - 1; k >= 0; --k)
+    if(n[k] != 0) return k * 32 + 64 - __builtin_clzll(n[k]);
+   return 0;
+  };
+  auto bits64 = [](const bignum & n, int pos) {                 // 64 bits from pos (could be < 0)
+   uint64_t r{0};
+   for(int b = 0; b < 64; ++b, ++pos)
+    if(pos >= 0 and pos / 32 < static_cast<int>(n.size()) and (n[pos / 32] >> pos % 32 & 1))
+     r |= 1ULL << b;
+   return r;
+  };
+  auto top128 = [&](const bignum & n) {
+   int len = bitlen(n);
+   return Pow{bits64(n, len - 64), bits64(n, len - 128)};
+  };
+  auto up = [](Pow p) { if(++p.lo == 0) ++p.hi; return p; };   // floor(p) + 1
+  auto mul5 = [](bignum & n) {
+   uint64_t carry{0};
+   for(auto & x: n) { carry += static_cast<uint64_t>(x) * 5; x = carry; carry >>= 32; }
+   if(carry != 0) n.push_back(carry);
+  };
+  auto div5 = [](bignum & n) {
+   uint64_t rem{0};
+   for(int k = n.size() - 1; k >= 0; --k)
+    { rem = rem << 32 | n[k]; n[k] = rem / 5; rem %= 5; }
+  };
+
+  Tables tbl;
+  tbl.pow5.resize(FPC_MAXP - FPC_MINP + 1);
+  tbl.pow10.resize(FPC_MAXP - FPC_MINP + 1);
+  bignum p5{1};                                                 // 5^q
+  for(int q = 0; q <= FPC_MAXP; ++q, mul5(p5)) {                // truncated 5^q
+   tbl.pow5[q - FPC_MINP] = top128(p5);
+   tbl.pow10[q - FPC_MINP] = up(tbl.pow5[q - FPC_MINP]);
+  }
+
+  const int B = 2048;                                           // x = floor(2^B / 5^k)
+  bignum x(B / 32 + 1, 0);
+  x.back() = 1;
+  p5.assign(1, 1);
+  for(int k = 1; k <= -FPC_MINP; ++k) {                         // 2^b / 5^k + 1, truncated
+   div5(x); mul5(p5);
+   int z = bitlen(p5);
+   int b = k <= 27? z + 127: 2 * z + 128;
+   bignum y(x.size(), 0);                                       // y = floor(2^b / 5^k) + 1
+   for(size_t j = 0; j < y.size(); ++j)
+    y[j] = bits64(x, B - b + 32 * j);
+   for(auto & v: y) if(++v != 0) break;
+   tbl.pow5[-k - FPC_MINP] = top128(y);
+   tbl.pow10[-k - FPC_MINP] = up(top128(x));                    // floor(2^B / 5^k) is exact
+  }
+  return tbl;
+ }();
+ return tbl;
+}
+
+#undef FPC_MINP
+#undef FPC_MAXP
+#undef FPC_MAXD
+#undef FPC_FIXD
+#undef FPC_BUFS
+
+
@@ -0,0 +1,237 @@
+/*
+ * a trivial micro class reading an input (file or a stream descriptor) into memory
+ *
+ * - regular files are memory mapped (no copying at all), while pipes, terminals and
+ *   other non-mappable inputs are read(2) in large blocks
+ * - the resulting buffer is always NUL terminated (mapped files too), hence could be
+ *   handed over to a NUL-sentinel parser (e.g. Json::parse(const char *)) directly
+ * - input could be read either entirely (read()), or incrementally (stream()): then
+ *   each fill() appends whatever is available from the descriptor, while drop() releases
+ *   already consumed part of the input (hence memory usage remains bounded)
+ *
+ * SYNOPSIS:
+ *  Inbuf ib;
+ *
+ *  ib.read("file.json");               // or: ib.read() - reads <stdin>
+ *  Json json;
+ *  json.parse(ib.data());
+ *  std::cout << "read " << ib.size() << " bytes, "
+ *            << (ib.is_mapped()? "mapped": "buffered") << std::endl;
+ *
+ *  ib.stream();                        // incremental reading of <stdin>
+ *  const char * ptr = ib.data();
+ *  while(not ib.is_eof()) {
+ *   size_t offset = ptr - ib.data();   // fill() may relocate the buffer
+ *   ib.fill();
+ *   ptr = ib.data() + offset;
+ *   // ... consume input, advancing ptr
+ *   ptr = ib.drop(ptr);                // release consumed input
+ *  }
+ *
+ * if a file cannot be opened, the buffer remains empty (data() returns "")
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <cstring>              // memmove
+#include <cerrno>               // errno, EINTR
+#include <fcntl.h>              // open
+#include <unistd.h>             // read, close, sysconf
+#include <sys/mman.h>           // mmap, munmap, madvise
+#include <sys/stat.h>           // fstat
+#include "extensions.hpp"
+#include "dbg.hpp"
+
+
+#define IBF_BLOCK (1024 * 1024)                                 // default read(2) block size
+
+
+
+
+
+
+class Inbuf {
+ public:
+                        Inbuf(size_t bs = IBF_BLOCK): bs_{bs} {}
+                        Inbuf(const Inbuf &) = delete;
+    Inbuf &             operator=(const Inbuf &) = delete;
+                       ~Inbuf(void) { release(); }
+
+    Inbuf &             read(const std::string & fname);
+    Inbuf &             read(int fd = STDIN_FILENO);
+    Inbuf &             stream(const std::string & fname);
+    Inbuf &             stream(int fd = STDIN_FILENO);
+    size_t              fill(void);
+    const char *        drop(const char * upto);
+    Inbuf &             release(void);
+    const char *        data(void) const { return mp_ != nullptr? mp_: vb_.data(); }
+    const char *        end(void) const { return data() + size_; }
+    size_t              size(void) const { return size_; }
+    bool                empty(void) const { return size_ == 0; }
+    bool                is_mapped(void) const { return mp_ != nullptr; }
+    bool                is_eof(void) const { return fd_ < 0; }
+    size_t              block_size(void) const { return bs_; }
+    Inbuf &             block_size(size_t bs) { bs_ = bs; return *this; }
+
+    DEBUGGABLE()
+
+ private:
+    bool                map_(int fd);
+    void                close_(void);
+
+    const char *        mp_{nullptr};                           // mapped region (if mapped)
+    size_t              ml_{0};                                 // mapped region length
+    size_t              dl_{0};                                 // dropped length of mapped region
+    std::vector<char>   vb_{'\0'};                              // read buffer (if not mapped)
+    size_t              size_{0};                               // size of the read input
+    size_t              bs_;                                    // read(2) block size
+    int                 fd_{-1};                                // streamed descriptor (till EOF)
+    bool                own_fd_{false};                         // fd_ was opened by Inbuf
+};
+
+#undef IBF_BLOCK
+
+
+
+Inbuf & Inbuf::read(const std::string & fname) {
+ // read entire file: map it if it's a regular file, otherwise read it by blocks
+ stream(fname);
+ while(fill() > 0);
+ DBG(2) DOUT() << "read " << size_ << " bytes" << std::endl;
+ return *this;
+}
+
+
+
+Inbuf & Inbuf::read(int fd) {
+ // read entire (already open) descriptor, e.g. stdin; regular files are mapped too
+ stream(fd);
+ while(fill() > 0);
+ DBG(2) DOUT() << "read " << size_ << " bytes" << std::endl;
+ return *this;
+}
+
+
+
+Inbuf & Inbuf::stream(const std::string & fname) {
+ // start incremental reading of the file (regular files are mapped entirely)
+ release();
+ int fd = open(fname.c_str(), O_RDONLY);
+ if(fd < 0) {
+  DBG(0) DOUT() << "could not open file '" << fname << "'" << std::endl;
+  return *this;
+ }
+ if(map_(fd))
+  { ::close(fd); return *this; }
+
+ fd_ = fd;
+ own_fd_ = true;
+ return *this;
+}
+
+
+
+Inbuf & Inbuf::stream(int fd) {
+ // start incremental reading of the (already open) descriptor; if it's a regular file
+ // positioned at the beginning, then it's mapped entirely
+ release();
+ if(lseek(fd, 0, SEEK_CUR) == 0 and map_(fd))
+  return *this;
+ fd_ = fd;
+ return *this;
+}
+
+
+
+size_t Inbuf::fill(void) {
+ // read (append) whatever is available in the streamed descriptor, blocks if nothing is;
+ // return number of bytes read, 0 when reached EOF (then descriptor is closed)
+ if(fd_ < 0) return 0;
+ if(vb_.size() - size_ <= bs_)                                  // keep room for a terminator
+  vb_.resize(size_ + bs_ + 1);                                  // (vector grows geometrically)
+
+ ssize_t rc;
+ do rc = ::read(fd_, vb_.data() + size_, vb_.size() - size_ - 1);
+ while(rc < 0 and errno == EINTR);
+
+ if(rc <= 0) { close_(); rc = 0; }                              // EOF or a read error
+ size_ += rc;
+ vb_[size_] = '\0';
+ return rc;
+}
+
+
+
+const char * Inbuf::drop(const char * upto) {
+ // release input prior upto, return relocated upto (i.e. the new data())
+ if(mp_ != nullptr) {                                           // mapped pages are discarded
+  size_t page = sysconf(_SC_PAGESIZE);
+  size_t dl = (upto - mp_) / page * page;
+  if(dl > dl_) {
+   madvise(const_cast<char*>(mp_) + dl_, dl - dl_, MADV_DONTNEED);
+   dl_ = dl;
+  }
+  return upto;
+ }
+
+ size_t dl = upto - vb_.data();
+ std::memmove(vb_.data(), upto, size_ - dl + 1);                // move with the terminator
+ size_ -= dl;
+ if(vb_.capacity() > 4 * (size_ + bs_ + 1))                     // buffer excessively big
+  { vb_.resize(size_ + bs_ + 1); vb_.shrink_to_fit(); }
+ return vb_.data();
+}
+
+
+
+Inbuf & Inbuf::release(void) {
+ // release mapped region and/or read buffer
+ if(mp_ != nullptr)
+  munmap(const_cast<char*>(mp_), ml_);
+ mp_ = nullptr;
+ ml_ = dl_ = size_ = 0;
+ vb_.assign(1, '\0');
+ vb_.shrink_to_fit();
+ close_();
+ return *this;
+}
+
+
+
+void Inbuf::close_(void) {
+ // stop streaming descriptor
+ if(own_fd_) ::close(fd_);
+ fd_ = -1;
+ own_fd_ = false;
+}
+
+
+
+bool Inbuf::map_(int fd) {
+ // map a regular file followed by at least one zero byte: first an anonymous (zeroed)
+ // region of a size + 1 is reserved, then the file is mapped over it. Thus, the NUL
+ // terminator exists even when the file size is an exact multiple of the page size
+ struct stat st;
+ if(fstat(fd, &st) != 0 or not S_ISREG(st.st_mode) or st.st_size == 0)
+  return false;
+
+ size_t fsize = st.st_size;
+ size_t page = sysconf(_SC_PAGESIZE);
+ ml_ = (fsize / page + 1) * page;                               // always > fsize
+
+ void * rp = mmap(nullptr, ml_, PROT_READ, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+ if(rp == MAP_FAILED)
+  { ml_ = 0; return false; }
+ void * fp = mmap(rp, fsize, PROT_READ, MAP_PRIVATE | MAP_FIXED, fd, 0);
+ if(fp == MAP_FAILED)
+  { munmap(rp, ml_); ml_ = 0; return false; }
+
+ madvise(fp, fsize, MADV_SEQUENTIAL);                           // hint kernel for read-ahead
+ mp_ = static_cast<const char*>(fp);
+ size_ = fsize;
+ DBG(2) DOUT() << "mapped " << size_ << " bytes" << std::endl;
+ return true;
+}
+
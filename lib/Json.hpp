@@ -44,6 +44,36 @@
  *  ,or use a string with _json suffix:
  *      json = R"({ "label 1": [ null, true, 2, "three" ] })"_json;
  *
+ *  large inputs (especially string-heavy ones) parse faster in two stages: a structural
+ *  index is built first (see Sindex.hpp), then the tree is built from it:
+ *      json.indexed().parse( ... );
+ *
+ *  a huge top-level array (or object) could be parsed concurrently: it's split at top-level
+ *  commas into spans, which are parsed by worker threads and then spliced in order:
+ *      json.concurrent().parse( ... );          // hardware_concurrency() threads
+ *
+ *  when only a small part of a huge json is accessed, it could be parsed lazily: nested
+ *  iterables are validated but kept raw, each is parsed (one level) once accessed:
+ *      json.lazy().parse( ... );
+ *
+ *  input doesn't have to be NUL terminated, if bounded explicitly - then e.g. a mapped
+ *  region or a network buffer could be parsed in place (w/o copying into a string):
+ *      json.parse(buf, buf + len);
+ *
+ *  c) inputs could be consumed without building a JSON tree at all - via events:
+ *      Json::Events ev;
+ *      size_t n{0};
+ *      ev.number = [&n](const std::string &) { ++n; };
+ *      ev.label = [](const std::string & lbl) { std::cout << lbl << std::endl; };
+ *      json.parse(R"({ "a": [1, 2], "b": 3 })", ev);   // prints a, b; n == 3
+ *
+ *  events are validated exactly as in the tree parsing, upon a failure an exception
+ *  is thrown (events for already parsed values will have been called by then).
+ *  string values and labels are given unmodified (i.e. JSON quoted)
+ *
+ *  when only well-formedness and the size are needed, input could be counted likewise:
+ *      size_t size = json.count(R"({ "a": [1, 2], "b": 3 })");  // size == 5
+ *
  *
  * 2. Accessing JSON
  *  Say, we have a following JSON:
@@ -134,22 +164,28 @@
  *  Note, any Json element is printed in JSON format (strings are quoted, arrays,
  *  object are enclosed into corresponding braces). If we want to access JSON's
  *  atomic values themselves there methods allowing accessing those:
- *      str() - returns const std::string value, type checked
+ *      str() - returns std::string value, type checked
  *      num() - type checked - return double type, type checked
+ *      integer() - type checked - return int64_t type (exact if is_integer())
  *      bul() - returns bool type, type checked
  *      val() - returns std::string value w/o type checking (actually it checks
  *              only if accessed value is atomic: numeric/boolean/string/null and
  *              neither of: array/object)
  *
- *  Internally, Json keeps all the atomic values as std::string along with associated
- *  type - Jtype (String, Number, Bool, Null).
- *  - num() for example, will convert a string to a double and return the value
- *    (but first will check if the accessed JSON has type Jtype::Number - if not
- *     it will throw 'expected_numerical_type' exception)
- *  - boolean values are stored internally as strings "T" and "F" respectively (along
- *    with Jtype::Bool)
- *  - null values are kept as empty string with Jtype::Null type
- *  if we want to access internal (std::string) representation of the atomic value
+ *  Internally, Json keeps all the atomic values as a compact text (along with associated
+ *  type - Jtype: String, Number, Bool, Null), right in the node:
+ *  - texts up to 8 chars are kept inline, longer ones - in a text block (allocated from
+ *    the arena)
+ *  - numbers are also kept in a binary form (converted once, when parsed), num() for
+ *    example, will return it as a double (but first will check if the accessed JSON
+ *    has type Jtype::Number - if not it will throw 'expected_numerical_type' exception);
+ *    canonical integers (e.g. 123, -5) are kept in a binary form only, their text is
+ *    formatted when accessed
+ *  - boolean values are kept in a binary form, their text reads "T" and "F"
+ *    respectively (along with Jtype::Bool)
+ *  - null values have an empty text with Jtype::Null type
+ *  str() and val() return the text by value (a copy); if we want to access the text of
+ *  the atomic value
  *  w/o type checking - val() method to be used.
  *
  *  So, following code prints all phone numbers as native values:
@@ -234,22 +270,30 @@
  *      is_atomic()     // i.e. string/number/bull/null
  *
  *  Json trees could be compared using '==' and '!=' operators.
- *      size() - calculates entire JSON tree size (number of nodes)
+ *      size() - calculates entire JSON tree size (number of nodes); iterable's size is
+ *               cached (just like hash), hence re-sizing unmodified nodes is O(1)
  *      has_children() - checks if given Json actually has any children (atomic
  *                       values would return false unconditionally
  *      children(void) - returns how many immediate children a JSON has (atomic
  *                       json always return 0)
+ *      hash() - structural hash: equal jsons hash equally (iterable's hash is cached
+ *               until the iterable is modified, hence comparing unequal iterables is
+ *               mostly O(1))
+ *      footprint() - memory used (in bytes) by nodes, strings (texts and labels) and
+ *                    containers (of children); Json's one also accounts its search
+ *                    cache and namespace
  *
  *  Facilitating iterations:
  *      begin() - returns iterator / const_iterator
  *      end() - end of iterator / const_iterator
  *      find() - finds and returns an iterator among immediate children
  *      label() - returns a reference to an entry's label - can only be used by
- *                super nodes dereferenced from iterators over objects, otherwise
- *                'label_accessed_not_via_iterator' exception will be thrown
+ *                super nodes dereferenced from iterators over objects (a super node
+ *                made of a plain node, i.e. Json::iterator::SuperJnode{jnode}, throws
+ *                'label_accessed_not_via_iterator' exception)
  *      index() - returns an entry's ordinal index - can only be used by super
- *                nodes dereferenced from iterators over arrays, otherwise
- *                'index_accessed_not_via_iterator' exception will be thrown
+ *                nodes dereferenced from iterators over arrays (likewise, otherwise
+ *                'index_accessed_not_via_iterator' exception will be thrown)
  *      value() - returns reference to a Jnode - optionally used by super nodes
  *                (methods label() and value() facilitate the same meaning as members
  *                'first' and 'second' when dereferencing map's iterators)
@@ -363,8 +407,8 @@
  *      - lexeme(pos)       // returns string lexeme (w/o suffix or quantifier)
  *      - type(pos)         // returns classified search type (Json::Jsearch)
  *
- *    A super node of dereferenced walk iterator also has some extra capabilities
- *    (in addition) to Jnode's:
+ *    A super node of dereferenced walk iterator (Json::iterator::SuperJnode) also has
+ *    some extra capabilities (in addition) to Jnode's:
  *      - is_root()         // checks if dereferenced node is root (returns true)
  *      - operator[]        // indexing operator adds a super power: a negative
  *                          // argument will return reference to its parents, e.g:
@@ -380,8 +424,12 @@
  *   'invalidate' - i.e. upon every new walk the entire search cache will be
  *   invalidated (cleared). If a user wants to keep the cache, he need to specify
  *   'keep_cache' keyword explicitly (at least the decision is conscious)
- *   CAUTION: Keeping the search cache after JSON has been modified may lead to
- *            undefined behavior.
+ *   Modifications via walk iterators (e.g.: *it = ..., it->erase(..)) drop only
+ *   the part of cache they could affect (searches off the modified node and off
+ *   its parents), so the rest of cache is kept actual
+ *   CAUTION: Keeping the search cache after JSON has been modified otherwise (e.g.
+ *            via a handed out Jnode &) may lead to undefined behavior, unless the
+ *            modification is told by clear_cache(it), see below
  *
  *
  *  Some examples:
@@ -426,8 +474,17 @@
  *
  * 7. About iterators
  *  Json class is a wrapper for underlying Jnode class, which actually implements
- *  JSON tree. Internally, Jnode class stores both JSON types arrays and objects
- *  in std::map container
+ *  JSON tree. Internally, Jnode class stores children of both JSON objects and arrays
+ *  in a vector of slots (see "Descendants.hpp"), object's children are kept sorted by
+ *  labels. Slots are bump-allocated from arena chunks (see "Arena.hpp"): a tree is
+ *  built without a per-node heap allocation, and memory of a destroyed tree is reused
+ *  by a next one. Labels are symbols (see "Symtab.hpp") interned per parsed document: a
+ *  repeated label is stored once. A copy of a Jnode shares node's children (it's
+ *  copy-on-write), so copying is O(1) until either copy is modified: then a single level
+ *  of children gets copied. Children, which references (or iterators) to were handed
+ *  out (e.g. by operator[], begin(), or by walking), are never shared: copying them is
+ *  a real copy. A node kept after its document is gone must be detached() from the
+ *  document's tree (within Arena::Lasting scope), otherwise it holds document's chunks
  *
  *  walk() method returns Json::iterator, while json's begin() method returns
  *  Jnode::iterator
@@ -435,9 +492,11 @@
  *  to compare Json::iterator with Jnode::iterator (only '==' and '!=' operators)
  *
  *  When iterator (either) is dereferenced, it returns a reference to a supernode,
- *  which in turn s child class from Jnode. The supernode is catered by the iterator
- *  and thus the supernode's lifetime is the same as iterator's from which it was
- *  dereferenced.
+ *  which is a view of the iterated Jnode (it's not a Jnode itself, thus Jnode carries
+ *  no virtual methods): it relays Jnode's interface onto the node and converts to
+ *  Jnode & implicitly. The supernode is catered by the iterator and thus the
+ *  supernode's lifetime is the same as iterator's from which it was dereferenced.
+ *  Note: assigning to a supernode assigns the viewed node (much like to a reference)
  *
  * 8. Callbacks
  *  there provided 2 types of callbacks for event-driven processing.
@@ -464,46 +523,72 @@
 #include <vector>
 #include <map>
 #include <string>
+#include <cstring>              // strchr, strncmp, memcpy
+#include <cstddef>              // offsetof
 #include <functional>           // function objects
 #include <sstream>              // std::stringstream
 #include <utility>              // std::forward, std::move, std::make_pair, ...
 #include <algorithm>            // std::min
 #include <limits>               // numeric_limits
 #include <climits>              // LONG_MAX, LONG_MIN
-#include <iomanip>              // std::setprecision
+#include <cmath>                // fabs, trunc
 #include <initializer_list>
 #include <regex>
+#include <deque>
+#include <unordered_set>        // accounting of shared memory (footprint)
+#include <thread>               // concurrent parsing
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#ifdef __SSE2__
+# include <emmintrin.h>            // vectorized scan of string bodies
+#endif
 #include "extensions.hpp"
 #include "dbg.hpp"
 #include "Outable.hpp"
+#include "Sindex.hpp"           // structural index (two-stage parsing)
+#include "Fpconv.hpp"           // number conversions
+#include "Arena.hpp"            // arena allocation of JSON trees
+#include "Symtab.hpp"           // interned labels
+#include "Descendants.hpp"      // children of iterables
 //#include "Blob.hpp"             // SERDES interface (not needed so far)
 
 
 
 // Class design notes:
 // Jnode represent a single JSON value of any kind (from null to object).
-// 1. for storing atomic JSON values (null, bool, string, number) an std:string
-//    is used - internally all JSON atomic values are stored like that, type/value
-//    validation occurs only during parsing.
+// 1. atomic JSON values (null, bool, string, number) are stored right in the node:
+//    a short text inline, a longer one in a text block; numbers in binary (plus the
+//    text only if it's not a canonical one), type/value validation occurs only
+//    during parsing. Thus a node is 24 bytes only (w/o its children container).
 // 2. JSON's Arrays and Objects are recurrent structures, which have to be stored
-//    in STL containers. Both arrays and objects could be stored using the same
-//    container type. Considering all implications, std::map it seems the most
-//    suitable container for JSON:
-//    - std::map caters random point remove/insert operations efficiently,
-//    - label search is O(log(n)) complexity; iteration is not much worse than
-//      vector's
-//    - for Array storage values (which do not require JSON labels), map keys will
-//      be auto-sequenced
+//    in STL containers. Both are kept in Descendants container (see
+//    "Descendants.hpp"), which is iterated alike for both:
+//    both are stored in a vector (of slots): indexing is O(1), appending is
+//    amortized O(1), while iterators remain as stable as map's
+//    - objects are kept sorted by labels: label search is O(log(n)) complexity,
+//      random point insert/remove is O(n) (a shift of pointers)
+//    - hence subscripting an object (e.g. [+0], >..<l) is as cheap as an array's
+//    - children are shared by copies of a node (copy-on-write), unless pinned by
+//      handing out references to them (children_()); parser and searches use
+//      children_unpinned_(), a walk pins only the children along found paths
+//    - iterable's structural hash is cached along with its children (dropped upon
+//      a non-const access), thus only equally hashed iterables are compared deeply;
+//      so is iterable's size (count of nodes), thus unmodified nodes are sized in O(1);
+//      pinned children keep neither (they could change via handed out references)
+// 3. Jnode has no virtual methods (hence no vptr): labels / indices of iterated nodes
+//    are provided by super nodes - views of nodes, which iterators dereference to
 
 
 #define DBG_WIDTH 74                                            // max print len upon parser's dbg
-#define ARRAY_LMT 4                                             // #bytes per array's index
 #define KEY first                                               // semantic for map's pair
 #define VALUE second                                            // instead of first/second
 #define GLAMBDA(FUNC) [this](auto&&... arg) { FUNC(std::forward<decltype(arg)>(arg)...); }
 
 #define PRINT_PRT '\n'                                          // pretty print separator
 #define PRINT_RAW ' '                                           // raw print separator
+#define TXT_INL 8                                               // max length of inline text
+#define TXT_OUT 0xFF                                            // text is out of line
 #define CHR_TRUE 'T'                                            // designator for Json 'true' value
 #define CHR_FALSE 'F'                                           // designator for Json 'false' val.
 #define CHR_NULL '\0'                                           // end of string
@@ -532,9 +617,11 @@
 #define PFX_WFR '^'                                             // walk from root offset
 #define PFX_WFL '-'                                             // walk from end-leaf offset
 #define RNG_SPR ':'                                             // quantifier range separator
-#define IDX_FIL '0'                                             // fill char for the node index
 #define QNT_OPN '{'                                             // quantifier interpolation open
 #define QNT_CLS '}'                                             // quantifier interpolation close
+#define JSN_PSPAN (256 * 1024)                                  // min span (concurrent parsing)
+#define HSH_PRIME 1099511628211ULL                              // FNV prime (mixing hashes)
+#define RBT_NODE (4 * sizeof(void *))                           // overhead of std::map's node
 
 
 #define JSN_FBDN "\b\f\n\r\t"                                   // forbidden JSON chars
@@ -557,16 +644,19 @@ class Jnode {
 
     friend void         swap(Jnode &l, Jnode &r) {
                          using std::swap;                       // enable ADL
-                         auto & lv = l.value();                 // first resolve super node
-                         auto & rv = r.value();
-                         swap(lv.type_, rv.type_);
-                         swap(lv.value_, rv.value_);
-                         swap(lv.descendants_, rv.descendants_);
+                         swap(l.type_, r.type_);
+                         swap(l.descendants_, r.descendants_);
+                         swap(l.lazy_, r.lazy_);
+                         swap(l.nint_, r.nint_);
+                         swap(l.tx_, r.tx_);
+                         swap(l.ni_, r.ni_);                    // (swaps entire value)
                         }
 
-    typedef std::map<std::string, Jnode> map_jn;
-    typedef map_jn::iterator iter_jn;
-    typedef map_jn::const_iterator const_iter_jn;
+    typedef Descendants<Jnode> desc_jn;
+    typedef std::map<Symbol, Jnode, std::less<>,
+                     Arena::Alloc<std::pair<const Symbol, Jnode>>> map_jn;
+    typedef desc_jn::iterator iter_jn;
+    typedef desc_jn::const_iterator const_iter_jn;
 
  public:
     #define THROWREASON \
@@ -653,46 +743,44 @@ class Jnode {
                           if(DBG()(0))
                            DOUT() << DBG_PROMPT(0) << "CC copying: " << jn.raw() << std::endl;
                          #endif
-                         auto * volatile jnv = &jn.value();     // when walk iterator is copied its
-                         if(jnv == nullptr)                     // supernode is empty, hence chck'n
-                          { type_ = jn.type_; return; }         // supernode's type is parent's
-                         // why volatile? compilers (mistakenly) believe that address of a returned
-                         // reference can never be a null, hence optimize out above 2 lines, which
-                         // leads to the crash inevitably. "volatile" disables such optimization
-                         type_ = jnv->type_;
-                         value_ = jnv->value_;
-                         descendants_ = jnv->descendants_;
+                         type_ = jn.type_;
+                         descendants_ = jn.descendants_;
+                         lazy_ = jn.lazy_;
+                         nint_ = jn.nint_;
+                         if(jn.tx_ != TXT_OUT)
+                          { tx_ = jn.tx_; ni_ = jn.ni_; }      // (copies entire inline value)
+                         else {
+                          const Text & t = *jn.txp_;
+                          memcpy(text_(t.size), t.str, t.size);
+                          txp_->ni = t.ni;
+                         }
                         }
 
-                        Jnode(Jnode &&jn) {                     // MC
-                         auto * volatile jnv = &jn.value();     // same here: moved jn could be an
-                         if(jnv == nullptr)                     // empty supernoe, hence checking
-                          { std::swap(type_, jn.type_); return; }
-                         swap(*this, jn);                       // swap will resolve supernode
-                        }
+                        Jnode(Jnode &&jn)                       // MC
+                         { swap(*this, jn); }
 
     Jnode &             operator=(Jnode jn) {                   // CA, MA
                          swap(*this, jn);
                          return *this;
                         }
 
+                       ~Jnode(void) { if(tx_ == TXT_OUT) free_(txp_); }
+
                         // type conversions from Json:
                         Jnode(Json j);
 
                         // atomic values constructor adapters:
-                        Jnode(double x): type_{Number} {
-                         std::stringstream ss;
-                         ss << std::setprecision(std::numeric_limits<double>::digits10) << x;
-                         value_ = ss.str();
-                        }
+                        Jnode(double x): type_{Number} { num_(x); }
 
-                        Jnode(const std::string & s): type_{String}, value_{s} {}
-                        Jnode(const char *s): type_{String}, value_{s} {}
+                        Jnode(const std::string & s): type_{String}
+                         { str_(s.data(), s.size()); }
+                        Jnode(const char *s): type_{String}
+                         { str_(s, strlen(s)); }
 
                         template<typename T>
                         Jnode(T b, typename std::enable_if<std::is_same<T,bool>::value>
                                                ::type * = nullptr):
-                         type_{Bool}, value_{b? CHR_TRUE: CHR_FALSE} {}
+                         type_{Bool} { ni_ = b; }
                         // w/o above concept it would clash with double type
 
                         template<typename T>
@@ -702,7 +790,7 @@ class Jnode {
 
 
                         // JSON atomic type adapters (string, numeric, boolean):
-                        operator const std::string & (void) const {
+                        operator std::string (void) const {
                          if(not is_string()) throw EXP(expected_string_type);
                          return str();
                         }
@@ -726,8 +814,8 @@ class Jnode {
                          return ss.str();
                         }
 
-    Jtype               type(void) const { return value().type_; }
-    Jtype &             type(void) { return value().type_; }
+    Jtype               type(void) const { return type_; }
+    Jtype &             type(void) { return type_; }
     bool                is_object(void) const { return type() == Object; }
     bool                is_array(void) const { return type() == Array; }
     bool                is_string(void) const { return type() == String; }
@@ -738,10 +826,14 @@ class Jnode {
     bool                is_atomic(void) const { return type() > Array; }
 
     size_t              size(void) const {                      // entire Jnode size
-                         size_t size = 1;
-                         for(auto &child: children_())
-                          size += child.VALUE.size();
-                         return size;
+                         size_t size = 0;                       // (children's one is cached)
+                         const auto & children = children_();
+                         if(not children.cached_total(size)) {
+                          for(auto &child: children)
+                           size += child.VALUE.size();
+                          children.cache_total(size);
+                         }
+                         return size + 1;
                         }
 
     bool                empty(void) const
@@ -753,28 +845,48 @@ class Jnode {
     size_t              children(void) const
                          { return children_().size(); }
 
+    size_t              hash(void) const;                       // structural hash (see below)
+
+    struct Footprint {                                          // memory used (bytes):
+        size_t          nodes{0};                               // - nodes themselves
+        size_t          strings{0};                             // - texts, labels
+        size_t          containers{0};                          // - children of iterables
+        size_t          cache{0};                               // - search cache (Json only)
+        size_t          ns{0};                                  // - namespace (Json only)
+        size_t          total(void) const
+                         { return nodes + strings + containers + cache + ns; }
+    };
+    Footprint           footprint(void) const {                 // memory used by entire Jnode
+                         Footprint fp;
+                         std::unordered_set<const void *> seen;
+                         footprint_(fp, seen);
+                         return fp;
+                        }
+
+    Jnode               detached(Symtab * st = nullptr) const;  // deep copy sharing nothing
+
     Jnode &             clear(void) {
                          if(is_atomic()) throw EXP(type_non_iterable);
-                         children_().clear();
+                         children_unpinned_().clear();
                          return *this;
                         }
 
-    virtual Jnode &     operator[](long i) {
+    Jnode &             operator[](long i) {
                          // long type is used instead of size_t b/c super node's overload
                          // supports negative offsets
                          if(is_atomic()) throw EXP(type_non_indexable);
                          return iterator_by_idx_(i)->VALUE;
                         }
 
-    virtual Jnode &     operator[](int i)
+    Jnode &             operator[](int i)
                          { return operator[](static_cast<long>(i)); }
 
-  virtual const Jnode & operator[](long i) const {
+    const Jnode &       operator[](long i) const {
                          if(is_atomic()) throw EXP(type_non_indexable);
                          return iterator_by_idx_(i)->VALUE;
                         }
 
-  virtual const Jnode & operator[](int i) const
+    const Jnode &       operator[](int i) const
                          { return operator[](static_cast<long>(i)); }
 
     Jnode &             operator[](const std::string & l) {
@@ -829,38 +941,60 @@ class Jnode {
 
     bool                operator==(const Jnode &jn) const {
                          if(type() != jn.type()) return false;
-                         if(is_iterable()) return children_() == jn.children_();
-                         else return val() == jn.val();
+                         if(is_iterable())                      // unequal hashes tell it fast
+                          return children_().size() == jn.children_().size() and
+                                 hash() == jn.hash() and children_() == jn.children_();
+                         Fpconv::Buf lb, rb;                    // atomics compare by text
+                         size_t ln, rn;
+                         const char * l = text_(lb, ln), * r = jn.text_(rb, rn);
+                         return ln == rn and memcmp(l, r, ln) == 0;
                         }
 
     bool                operator!=(const Jnode &jn) const { return not operator==(jn); }
 
                         // access json types (type checked)
-    const std::string & str(void) const {
+    std::string         str(void) const {
                          if(not is_string()) throw EXP(expected_string_type);
-                         return value().value_;
+                         size_t n;
+                         const char * s = chars_(n);
+                         return {s, n};
                         }
 
     double              num(void) const {
                          if(not is_number()) throw EXP(expected_numerical_type);
-                         return stod(value().value_);
+                         return nint_? int_(): dbl_();
+                        }
+
+    bool                is_integer(void) const                  // number is an exact int64
+                         { return is_number() and nint_; }
+
+    int64_t             integer(void) const {                   // exact, if is_integer(),
+                         if(not is_number()) throw EXP(expected_numerical_type);
+                         if(nint_) return int_();               // truncated otherwise
+                         double d = dbl_();
+                         if(not (std::fabs(d) < 9223372036854775808.0)) // out of range, nan
+                          return d < 0? INT64_MIN: INT64_MAX;
+                         return static_cast<int64_t>(d);
                         }
 
     bool                bul(void) const {
                          if(not is_bool()) throw EXP(expected_boolean_type);
-                         return value().value_.front() == CHR_TRUE;
+                         return ni_ != 0;
                         }
 
                         // return atomic value w/o atomic type checking
-    const std::string & val(void) const {
+    std::string         val(void) const {
                          if(is_iterable()) throw EXP(expected_atomic_type);
-                         return value().value_;
+                         Fpconv::Buf buf;
+                         size_t n;
+                         const char * s = text_(buf, n);
+                         return {s, n};
                         }
 
                         // modify json
     Jnode &             erase(const std::string & l) {
                          if(not is_object()) throw EXP(expected_object_type);
-                         children_().erase(l);
+                         children_unpinned_().erase(l);
                          return *this;
                         }
 
@@ -872,15 +1006,16 @@ class Jnode {
 
     Jnode &             push_back(Jnode jn) {
                          if(not is_array()) throw EXP(expected_array_type);
-                         children_().emplace(next_key_(), std::move(jn));
+                         children_unpinned_().append(std::move(jn));
                          return *this;
                         }
 
 
     Jnode &             pop_back(void) {
                          if(not is_iterable()) throw EXP(type_non_iterable);
-                         if(not children_().empty())
-                          children_().erase(std::prev(children_().end()));
+                         auto & children = children_unpinned_();
+                         if(not children.empty())
+                          children.erase(std::prev(children.end()));
                          return *this;
                         }
 
@@ -907,17 +1042,9 @@ class Jnode {
     iterator            find(size_t i);                         // for both arrays and objects
     const_iterator      find(size_t i) const;                   // for both arrays and objects
 
-                        // facilitating super node powers
-    virtual bool        has_label(void) const { throw EXP(label_accessed_not_via_iterator); }
-    virtual const std::string &
-                        label(void) const { throw EXP(label_accessed_not_via_iterator); }
-    virtual bool        has_index(void) const { throw EXP(index_accessed_not_via_iterator); }
-    virtual int64_t     index(void) const { throw EXP(index_accessed_not_via_iterator); }
-    virtual bool        is_root(void) const { throw EXP(method_accessed_not_via_iterator); }
-                        // label() / index() / is_root() supposed to be used by a super
-                        // node only (cannot be pure defined, hence throwing)
-    virtual Jnode &     value(void) { return *this; }           // for iterator
-  virtual const Jnode & value(void) const { return *this; }     // for iterator & const_iterator
+                        // super node: a view of a node dereferenced from an iterator,
+                        // facilitates label() / index() / value() (see below)
+    class SuperJnode;
 
                         // global print setting
     bool                is_pretty(void) const { return endl_ == PRINT_PRT; }
@@ -942,29 +1069,89 @@ class Jnode {
  protected:
                         Jnode(Jtype t):type_{t} {}              // for internal use
 
-    map_jn &            children_(void) { return value().descendants_; }
-    const map_jn &      children_(void) const { return value().descendants_; }
+    desc_jn &           children_(void) {                       // children to hand out: pinned
+                         if(lazy_) materialize_();
+                         return descendants_.pin();
+                        }
+    const desc_jn &     children_(void) const {
+                         if(lazy_) const_cast<Jnode*>(this)->materialize_();
+                         return descendants_;
+                        }
+    desc_jn &           children_unpinned_(void) {              // to modify only (copy-on-write)
+                         if(lazy_) materialize_();
+                         return descendants_;
+                        }
+    void                materialize_(void);
+    void                footprint_(Footprint & fp, std::unordered_set<const void *> & seen) const;
     iter_jn             iterator_by_idx_(size_t idx);
     const_iter_jn       iterator_by_idx_(size_t idx) const;
-    std::string         next_key_(void) const;
+
+    struct Text {                                               // out of line text
+        union {                                                 // binary value (of a number)
+         double         nd;
+         int64_t        ni;
+        };
+        size_t          size;
+        size_t          cap;
+        char            str[1];                                 // (NUL terminated)
+    };
+
+    const char *        chars_(size_t & n) const {              // stored text (string, raw json)
+                         if(tx_ != TXT_OUT) { n = tx_; return chr_; }
+                         n = txp_->size;
+                         return txp_->str;
+                        }
+    const char *        text_(Fpconv::Buf & buf, size_t & n) const;
+    bool                text_is_(const std::string & s) const { // atomic's text is s
+                         Fpconv::Buf buf;
+                         size_t n;
+                         const char * t = text_(buf, n);
+                         return n == s.size() and memcmp(t, s.data(), n) == 0;
+                        }
+    char *              text_(size_t n);
+    void                str_(const char * s, size_t n);
+    void                num_(const char * b, const char * e);
+    void                num_(double x);
+    void                num_(int64_t i)                         // (binary only)
+                         { drop_text_(); nint_ = true; ni_ = i; }
+    void                bul_(bool b) { drop_text_(); ni_ = b; }
+    int64_t             int_(void) const { return tx_ == TXT_OUT? txp_->ni: ni_; }
+    double              dbl_(void) const { return tx_ == TXT_OUT? txp_->nd: nd_; }
+    void                drop_text_(void)
+                         { if(tx_ == TXT_OUT) free_(txp_); tx_ = 0; }
+    static size_t       units_(size_t cap)                      // text block size (in int64s)
+                         { return (offsetof(Text, str) + cap + sizeof(int64_t)) / sizeof(int64_t); }
+    static void         free_(Text * tp)
+                         { Arena::Alloc<int64_t>{}.deallocate(reinterpret_cast<int64_t*>(tp),
+                                                              units_(tp->cap)); }
 
                         // Jnode data
     Jtype               type_{Object};
-    std::string         value_;                                 // value (number/string/bool/null)
-    map_jn              descendants_;                           // array/nodes (objects)
+    bool                lazy_{false};                           // iterable's raw json is in text
+    bool                nint_{false};                           // number is exact int64
+    uint8_t             tx_{0};                                 // inline text length, or TXT_OUT
+    desc_jn             descendants_;                           // array/nodes (objects)
+    union {                                                     // atomic's value:
+     int64_t            ni_{0};                                 // - binary of a number (w/o
+     double             nd_;                                    //   text), or of a boolean
+     char               chr_[TXT_INL];                          // - inline text (short string)
+     Text *             txp_;                                   // - out of line text
+    };
 
  private:
   static std::ostream & print_json_(std::ostream & os, const Jnode & me, long & rl);
   static std::ostream & print_iterables_(std::ostream & os, const Jnode & me, long & rl);
 
-    static char         endl_;                                  // either for raw or pretty print
-    static uint8_t      tab_;                                   // tab size (for indention)
+    static thread_local char                                    // either for raw or pretty print
+                        endl_;
+    static thread_local uint8_t                                 // tab size (for indention)
+                        tab_;
 
 };
 
 // class static definitions
-char Jnode::endl_{PRINT_PRT};                                   // default is pretty format
-uint8_t Jnode::tab_{3};
+thread_local char Jnode::endl_{PRINT_PRT};                      // default is pretty format
+thread_local uint8_t Jnode::tab_{3};
 
 STRINGIFY(Jnode::ThrowReason, THROWREASON)
 #undef THROWREASON
@@ -983,28 +1170,22 @@ struct NUL: public Jnode {
 
 struct BUL: public Jnode {
     BUL(bool x): Jnode{Bool}
-     { value_ = x? CHR_TRUE: CHR_FALSE; }
+     { bul_(x); }
 };
 
 struct NUM: public Jnode {
-    NUM(double x): Jnode{Number} {
-     std::stringstream ss;
-     ss << std::setprecision(std::numeric_limits<double>::digits10) << x;
-     value_ = ss.str();
-    }
+    NUM(double x): Jnode{x} {}
 };
 
 struct STR: public Jnode {
     STR(const std::string & x): Jnode{String}
-     { value_ = x; }
-    STR(std::string && x): Jnode{String}
-     { value_ = std::move(x); }
+     { str_(x.data(), x.size()); }
 };
 
 struct ARY: public Jnode {
     ARY(const std::initializer_list<Jnode> & array): Jnode{Array} {
      for(auto &jn: array)
-      children_().emplace(next_key_(), jn);
+      children_unpinned_().append(jn);
     }
 };
 
@@ -1016,7 +1197,7 @@ struct LBL: public Jnode {
 struct OBJ: public Jnode {
     OBJ(const std::initializer_list<LBL> & labels): Jnode{Object} {
      for(auto &l: labels)
-      children_().emplace(std::move(l.label), l);
+      children_unpinned_().emplace(std::move(l.label), l);
     }
 };
 
@@ -1024,17 +1205,162 @@ struct OBJ: public Jnode {
 
 
 
+//                          Super node implementation
+class Jnode::SuperJnode {
+ // super node is what iterators (Jnode's and Json's) are dereferenced to: it's a view
+ // of the iterated Jnode (not a Jnode itself), it relays Jnode's interface onto the
+ // viewed node and adds following powers:
+ // - label() allows accessing node's label if node is nested by object
+ // - index() allows accessing node's ordinal index if nested by array
+ // - value() provides access to the Jnode itself (the super node also converts to
+ //   Jnode & implicitly)
+ // a super node could be made of a plain node too (i.e. not via iterator), then
+ // label() / index() / is_root() throw
+    friend Jnode;
+    template<typename T> friend class Jnode::Iterator;
+
+  friend std::ostream & operator<<(std::ostream & os, const SuperJnode & sn)
+                         { return os << *sn.jnp_; }
+
+    friend void         swap(SuperJnode & l, SuperJnode & r)    // swaps nodes (not views)
+                         { swap(*l.jnp_, *r.jnp_); }
+
+ public:
+    explicit            SuperJnode(const Jnode & jn):           // super node of a plain node
+                         jnp_{const_cast<Jnode*>(&jn)}, via_{false} {}
+                        SuperJnode(const SuperJnode &) = default;       // CC (copies view)
+    SuperJnode &        operator=(const SuperJnode & sn)        // CA assigns viewed node
+                         { *jnp_ = *sn.jnp_; return *this; }
+    SuperJnode &        operator=(Jnode jn)
+                         { *jnp_ = std::move(jn); return *this; }
+
+    bool                has_label(void) const {
+                         if(not via_) throw jnp_->EXP(label_accessed_not_via_iterator);
+                         return lbp_ != nullptr and ptype_ == Object;
+                        }
+    const std::string & label(void) const {
+                         if(not via_) throw jnp_->EXP(label_accessed_not_via_iterator);
+                         if(ptype_ != Object) throw jnp_->EXP(label_request_for_non_object_enclosed);
+                         return *lbp_;
+                        }
+    bool                has_index(void) const {
+                         if(not via_) throw jnp_->EXP(index_accessed_not_via_iterator);
+                         return jnp_ != nullptr and ptype_ == Array;
+                        }
+    int64_t             index(void) const {
+                         if(not via_) throw jnp_->EXP(index_accessed_not_via_iterator);
+                         if(ptype_ != Array) throw jnp_->EXP(index_request_for_non_array_enclosed);
+                         return idx_;
+                        }
+    bool                is_root(void) const                     // (walk iterator's only)
+                         { throw jnp_->EXP(method_accessed_not_via_iterator); }
+    Jnode &             value(void) { return *jnp_; }
+    const Jnode &       value(void) const { return *jnp_; }
+                        operator Jnode &(void) { return *jnp_; }
+                        operator const Jnode &(void) const { return *jnp_; }
+
+    Jtype               parent_type(void) const { return ptype_; }
+    Jtype &             parent_type(void) { return ptype_; }
+
+    // relayed Jnode interface
+    std::string         to_string(PrettyType pt = Pretty) const { return jnp_->to_string(pt); }
+    Jtype               type(void) const { return jnp_->type(); }
+    Jtype &             type(void) { return jnp_->type(); }
+    bool                is_object(void) const { return jnp_->is_object(); }
+    bool                is_array(void) const { return jnp_->is_array(); }
+    bool                is_string(void) const { return jnp_->is_string(); }
+    bool                is_number(void) const { return jnp_->is_number(); }
+    bool                is_bool(void) const { return jnp_->is_bool(); }
+    bool                is_null(void) const { return jnp_->is_null(); }
+    bool                is_iterable(void) const { return jnp_->is_iterable(); }
+    bool                is_atomic(void) const { return jnp_->is_atomic(); }
+    bool                is_integer(void) const { return jnp_->is_integer(); }
+    size_t              size(void) const { return jnp_->size(); }
+    Footprint           footprint(void) const { return jnp_->footprint(); }
+    Jnode               detached(Symtab * st = nullptr) const { return cnode_().detached(st); }
+    bool                empty(void) const { return jnp_->empty(); }
+    bool                has_children(void) const { return jnp_->has_children(); }
+    size_t              children(void) const { return jnp_->children(); }
+    size_t              hash(void) const { return jnp_->hash(); }
+    Jnode &             clear(void) { return jnp_->clear(); }
+    Jnode &             operator[](long i) { return (*jnp_)[i]; }
+    Jnode &             operator[](int i) { return (*jnp_)[i]; }
+    const Jnode &       operator[](long i) const { return cnode_()[i]; }
+    const Jnode &       operator[](int i) const { return cnode_()[i]; }
+    Jnode &             operator[](const std::string & l) { return (*jnp_)[l]; }
+    Jnode &             operator[](const char * l) { return (*jnp_)[l]; }
+    const Jnode &       operator[](const std::string & l) const { return cnode_()[l]; }
+    const Jnode &       operator[](const char * l) const { return cnode_()[l]; }
+    Jnode &             front(void) { return jnp_->front(); }
+    const Jnode &       front(void) const { return cnode_().front(); }
+    const std::string & front_label(void) const { return jnp_->front_label(); }
+    Jnode &             back(void) { return jnp_->back(); }
+    const Jnode &       back(void) const { return cnode_().back(); }
+    const std::string & back_label(void) const { return jnp_->back_label(); }
+    bool                operator==(const Jnode & jn) const { return *jnp_ == jn; }
+    bool                operator!=(const Jnode & jn) const { return *jnp_ != jn; }
+    std::string         str(void) const { return jnp_->str(); }
+    double              num(void) const { return jnp_->num(); }
+    int64_t             integer(void) const { return jnp_->integer(); }
+    bool                bul(void) const { return jnp_->bul(); }
+    std::string         val(void) const { return jnp_->val(); }
+    Jnode &             erase(const std::string & l) { return jnp_->erase(l); }
+    Jnode &             erase(size_t i) { return jnp_->erase(i); }
+    Jnode &             push_back(Jnode jn) { return jnp_->push_back(std::move(jn)); }
+    Jnode &             pop_back(void) { return jnp_->pop_back(); }
+    iterator            begin(void);
+    const_iterator      begin(void) const;
+    const_iterator      cbegin(void) const;
+    iterator            end(void);
+    const_iterator      end(void) const;
+    const_iterator      cend(void) const;
+    Jnode &             erase(iterator & it);
+    Jnode &             erase(const_iterator & it);
+    Jnode &             erase(const_iterator && it);
+    size_t              count(const std::string & l) const { return jnp_->count(l); }
+    iterator            find(const std::string & l);
+    const_iterator      find(const std::string & l) const;
+    iterator            find(size_t i);
+    const_iterator      find(size_t i) const;
+    bool                is_pretty(void) const { return jnp_->is_pretty(); }
+    const Jnode &       pretty(bool x = true) const { return cnode_().pretty(x); }
+    bool                is_raw(void) const { return jnp_->is_raw(); }
+    const Jnode &       raw(bool x = true) const { return cnode_().raw(x); }
+    uint8_t             tab(void) const { return jnp_->tab(); }
+
+ protected:
+                        SuperJnode(Jtype t): ptype_{t} {}       // iterator's super node
+
+    SuperJnode &        operator()(const iter_jn & it) {        // view iterated child
+                         if(it.is_indexed()) { lbp_ = nullptr; idx_ = it.index(); }
+                         else lbp_ = &it->KEY.str();
+                         jnp_ = &it->VALUE;
+                         return *this;
+                        }
+    const Jnode &       cnode_(void) const { return *jnp_; }    // const access to the node
+
+    Jnode *             jnp_{nullptr};                          // viewed node
+    const std::string * lbp_{nullptr};                          // label (nullptr if indexed)
+    size_t              idx_{0};                                // index (if nested by array)
+    Jtype               ptype_{Neither};                        // parent's type
+    bool                via_{true};                             // made via iterator
+};
+
+
+
+
+
 //                          Jnode iterator implementation
 class Json;
 template<typename T>
-class Jnode::Iterator: public std::iterator<std::bidirectional_iterator_tag, T> {
+class Jnode::Iterator: public std::iterator<std::bidirectional_iterator_tag,
+                                            typename std::conditional<std::is_const<T>::value,
+                                                     const SuperJnode, SuperJnode>::type> {
  // this bidirectional iterator let iterating over children in given JSON iterable
  // (array or object)
- // once iterator is dereferenced it returns a reference to a Jnode's super-node,
- // super-node adds following powers to regular Jnode's:
- // - label() allows accessing node's label if node is nested by object
- // - index() allows accessing node's ordinal index if nested by array
- // - value() provides access to the Jnode itself (but this methods is somewhat redundant)
+ // once iterator is dereferenced it returns a reference to a Jnode's super node (a view
+ // of the child, see SuperJnode above), i.e. in addition to the Jnode's interface
+ // label() / index() / value() are available
     friend Jnode;
     friend Json;
     friend void         swap(Jnode::Iterator<T> &l, Jnode::Iterator<T> &r) {
@@ -1043,52 +1369,14 @@ class Jnode::Iterator: public std::iterator<std::bidirectional_iterator_tag, T>
                          swap(l.sn_.parent_type(), r.sn_.parent_type());// supernode requires
                         }                                           // swapping of type_ only
 
-    // Supernode definition
-    //
-    class SuperJnode: public Jnode {
-        friend Jnode;
-        friend Jnode::Iterator<T>;
-
-     public:
-        bool                has_label(void) const
-                             { return lbp_ != nullptr and parent_type() == Object; }
-        const std::string & label(void) const {
-                             if(type_ != Object) throw EXP(label_request_for_non_object_enclosed);
-                             return *lbp_;
-                            }
-        bool                has_index(void) const
-                             { return lbp_ != nullptr and parent_type() == Array; }
-        int64_t             index(void) const {
-                             if(type_ != Array) throw EXP(index_request_for_non_array_enclosed);
-                             return std::stoul(lbp_->c_str(), nullptr, 16);
-                            }
-        Jnode &             value(void) { return *jnp_; }       // do not template
-        const Jnode &       value(void) const { return *jnp_; } // these methods
-
-        Jtype               parent_type(void) const { return type_; }
-        Jtype &             parent_type(void) { return type_; } // this is a work around GNU's
-                            // compiler bug/limitation, which does not extend scoping visibility
-                            // onto subclasses: i.e. swap(l.sn_.type_, r.sn_.type_) fails.
-     private:
-                            SuperJnode(void) = delete;          // DC
-                            SuperJnode(Jtype t): Jnode{t} {}    // Init Construct
-
-        SuperJnode &        operator()(const std::string &s, Jnode &jn)
-                             { lbp_ = &s; jnp_ = &jn; return *this; }
-        const SuperJnode &  operator()(const std::string &s, const Jnode &jn) const
-                             { lbp_ = &s; jnp_ = &jn; return *this; }
-
-        const std::string * lbp_{nullptr};                      // pointer to a label string
-        Jnode *             jnp_{nullptr};                      // resolved Jnode pointer
-    };
-    //
-    // end of Super node definition
+    typedef typename std::conditional<std::is_const<T>::value,  // (const) super node
+                                      const SuperJnode, SuperJnode>::type Super;
 
  public:
                         Iterator(void) = default;               // DC
                         Iterator(const Iterator &it):           // CC
                          ji_(it.ji_)
-                          { sn_.type_ = it.sn_.type_; }
+                          { sn_.parent_type() = it.sn_.parent_type(); }
                         Iterator(Iterator &&it)                 // MC
                          { swap(*this, it); }
     Iterator &          operator=(Iterator it)                  // CA, MA
@@ -1096,7 +1384,7 @@ class Jnode::Iterator: public std::iterator<std::bidirectional_iterator_tag, T>
 
                         // convert to const_iterator (from iterator)
                         operator Iterator<const Jnode>(void) const
-                         { return {ji_, sn_.type_}; }
+                         { return {ji_, sn_.parent_type()}; }
 
     bool                operator==(const iterator & rhs) const
                          { return underlying_() == rhs.underlying_(); }
@@ -1106,10 +1394,8 @@ class Jnode::Iterator: public std::iterator<std::bidirectional_iterator_tag, T>
                          { return underlying_() == rhs.underlying_(); }
     bool                operator!=(const const_iterator & rhs) const
                          { return underlying_() != rhs.underlying_(); }
-    T &                 operator*(void)
-                         { return sn_(underlying_()->KEY, underlying_()->VALUE); }
-    T *                 operator->(void)
-                         { return &sn_(underlying_()->KEY, underlying_()->VALUE); }
+    Super &             operator*(void) { return sn_(underlying_()); }
+    Super *             operator->(void) { return &sn_(underlying_()); }
     Iterator<T> &       operator++(void) { ++ji_; return *this; }
     Iterator<T> &       operator--(void) { --ji_; return *this; }
     Iterator<T>         operator++(int) { auto tmp{*this}; ++(*this); return tmp; }
@@ -1130,7 +1416,7 @@ class Jnode::Iterator: public std::iterator<std::bidirectional_iterator_tag, T>
                                              ::type * = nullptr):
                          ji_{reinterpret_cast<iter_jn&&>(mi)}, sn_{jt} {}
 
-    // reminder: typedef std::map<std::string, Jnode>::iterator iter_jn;
+    // reminder: typedef desc_jn::iterator iter_jn;
     iter_jn             ji_;
     SuperJnode          sn_{Neither};
 
@@ -1236,25 +1522,94 @@ Jnode::const_iterator Jnode::find(size_t idx) const {
 }
 
 
+size_t Jnode::hash(void) const {
+ // equal jsons hash equally: atomic's hash is of its text, iterable's one is of labels
+ // and children's hashes, which is cached in the children container (until changed)
+ size_t h = type();
+ if(is_atomic()) {
+  Fpconv::Buf buf;
+  size_t n;
+  const char * s = text_(buf, n);
+  return (h ^ Symbol::hash_(s, n)) * HSH_PRIME;
+ }
+
+ const auto & children = children_();
+ if(children.cached_hash(h)) return h;
+ for(auto & child: children) {
+  if(not children.is_indexed()) h = (h ^ child.KEY.hash()) * HSH_PRIME;
+  h = (h ^ child.VALUE.hash()) * HSH_PRIME;
+ }
+ children.cache_hash(h);
+ return h;
+}
+
+
+void Jnode::footprint_(Footprint & fp, std::unordered_set<const void *> & seen) const {
+ // account memory of the node and its descendants: children shared by copies (copy-on-
+ // write) and interned labels are accounted once (the first time seen); raw text of a
+ // lazy iterable is accounted as a string (it's not materialized)
+ fp.nodes += sizeof(Jnode);
+ if(tx_ == TXT_OUT) fp.strings += units_(txp_->cap) * sizeof(int64_t);
+ if(is_atomic()) return;
+ if(descendants_.is_shared() and not seen.insert(descendants_.identity()).second) return;
+
+ fp.containers += descendants_.footprint();
+ for(auto & child: descendants_) {
+  if(not child.KEY.is_null() and seen.insert(&child.KEY.str()).second)
+   fp.strings += child.KEY.footprint();
+  child.VALUE.footprint_(fp, seen);
+ }
+}
+
+
+Jnode Jnode::detached(Symtab * st) const {
+ // deep copy holding no blocks of this node's tree: children are copied rather than
+ // shared, labels are made anew or interned in the given table (e.g. to keep a result of
+ // a parsed document in Arena::Lasting scope once the document is gone)
+ Jnode jn{type_};
+ jn.lazy_ = lazy_;
+ jn.nint_ = nint_;
+ if(tx_ != TXT_OUT)
+  { jn.tx_ = tx_; jn.ni_ = ni_; }
+ else {
+  memcpy(jn.text_(txp_->size), txp_->str, txp_->size);
+  jn.txp_->ni = txp_->ni;
+ }
+ for(auto & child: descendants_)
+  if(descendants_.is_indexed()) jn.descendants_.append(child.VALUE.detached(st));
+  else jn.descendants_.append(st == nullptr? Symbol{child.KEY.str()}: st->intern(child.KEY),
+                              child.VALUE.detached(st));
+ if(not descendants_.is_indexed()) jn.descendants_.sort();     // (sorted already, typically)
+ return jn;
+}
+
+
+// super node's relayed iterators
+Jnode::iterator Jnode::SuperJnode::begin(void) { return jnp_->begin(); }
+Jnode::const_iterator Jnode::SuperJnode::begin(void) const { return cnode_().begin(); }
+Jnode::const_iterator Jnode::SuperJnode::cbegin(void) const { return cnode_().cbegin(); }
+Jnode::iterator Jnode::SuperJnode::end(void) { return jnp_->end(); }
+Jnode::const_iterator Jnode::SuperJnode::end(void) const { return cnode_().end(); }
+Jnode::const_iterator Jnode::SuperJnode::cend(void) const { return cnode_().cend(); }
+Jnode & Jnode::SuperJnode::erase(iterator & it) { return jnp_->erase(it); }
+Jnode & Jnode::SuperJnode::erase(const_iterator & it) { return jnp_->erase(it); }
+Jnode & Jnode::SuperJnode::erase(const_iterator && it) { return jnp_->erase(std::move(it)); }
+Jnode::iterator Jnode::SuperJnode::find(const std::string & l) { return jnp_->find(l); }
+Jnode::const_iterator Jnode::SuperJnode::find(const std::string & l) const
+ { return cnode_().find(l); }
+Jnode::iterator Jnode::SuperJnode::find(size_t i) { return jnp_->find(i); }
+Jnode::const_iterator Jnode::SuperJnode::find(size_t i) const { return cnode_().find(i); }
+
+
 //
 // Jnode private methods implementation
 //
 Jnode::iter_jn Jnode::iterator_by_idx_(size_t idx) {
- // iterator_by_idx_ may be used in both array and dictionary indexing operation.
+ // iterator_by_idx_ may be used in both array and dictionary indexing operation:
+ // children of either are addressed directly
  if(idx >= children_().size())
   throw EXP(index_out_of_range);
-
- if(is_array()) {                                               // array could be addressed direct
-  size_t key = stoul(children_().rbegin()->KEY, nullptr, 16);
-  if(key < children_().size()) {                                // if so, indices are non-tampered
-   std::stringstream ss;
-   ss << std::hex << std::setfill(IDX_FIL) << std::setw(ARRAY_LMT * 2) << idx;
-   return children_().find( ss.str() );
-  }
- }                                                              // else: traverse map
- auto it = children_().begin();
- std::advance(it, idx);
- return it;
+ return children_().nth(idx);
 }
 
 
@@ -1262,34 +1617,81 @@ Jnode::const_iter_jn Jnode::iterator_by_idx_(size_t idx) const {
  // const version
  if(idx >= children_().size())
   throw EXP(index_out_of_range);
+ return children_().nth(idx);
+}
 
- if(is_array()) {                                               // array may be addressed directly
-  size_t key = stoul(children_().rbegin()->KEY, nullptr, 16);
-  if(key < children_().size()) {                                // if so, indices are non-tampered
-   std::stringstream ss;
-   ss << std::hex << std::setfill(IDX_FIL) << std::setw(ARRAY_LMT * 2) << idx;
-   return children_().find(std::move(ss.str()));
-  }
- }                                                              // else: traverse map
- auto it = children_().cbegin();
- std::advance(it, idx);
- return it;
+
+const char * Jnode::text_(Fpconv::Buf & buf, size_t & n) const {
+ // text of an atomic: either stored one, or printed into buf (numbers w/o text, booleans)
+ if(type_ == Bool)
+  { buf[0] = ni_? CHR_TRUE: CHR_FALSE; n = 1; return buf; }
+ if(type_ == Number and tx_ != TXT_OUT)
+  { n = nint_? Fpconv::format(ni_, buf): Fpconv::format(nd_, buf); return buf; }
+ return chars_(n);
 }
 
 
-std::string Jnode::next_key_(void) const {
- size_t key = 0;
- if(not children_().empty())
-  key = stoul(children_().rbegin()->KEY, nullptr, 16) + 1;
- std::stringstream ss;
- ss << std::hex << std::setfill(IDX_FIL) << std::setw(ARRAY_LMT * 2) << key;
+char * Jnode::text_(size_t n) {
+ // make out of line text of n chars (existing block is reused if it fits), return its chars
+ if(tx_ != TXT_OUT or txp_->cap < n) {
+  size_t units = units_(n);
+  Text * tp = reinterpret_cast<Text*>(Arena::Alloc<int64_t>{}.allocate(units));
+  tp->cap = units * sizeof(int64_t) - offsetof(Text, str) - 1;
+  drop_text_();
+  txp_ = tp;
+  tx_ = TXT_OUT;
+ }
+ txp_->size = n;
+ txp_->str[n] = CHR_NULL;
+ return txp_->str;
+}
+
+
+void Jnode::str_(const char * s, size_t n) {
+ // set text of a string: a short one is kept inline (unless out of line block is there)
+ if(n <= TXT_INL and tx_ != TXT_OUT)
+  { memcpy(chr_, s, n); tx_ = n; return; }
+ memcpy(text_(n), s, n);
+}
+
+
+void Jnode::num_(const char * b, const char * e) {
+ // set number from its text: canonical integers (i.e. not like "-0", "1.0", "1e1") are
+ // kept in binary only, others keep text along (printed as given)
+ double d;
+ int64_t i;
+ nint_ = Fpconv::parse(b, e, d, i);
+ if(nint_) {
+  const char * p = b + (*b == JSN_NUMM);
+  bool canonical = *p != '0' or e - p == 1;
+  for(; canonical and p < e; ++p)
+   canonical = *p >= '0' and *p <= '9';
+  if(canonical) return num_(i);
+ }
+ memcpy(text_(e - b), b, e - b);
+ if(nint_) txp_->ni = i;
+ else txp_->nd = d;
+}
+
 
- return ss.str();
+void Jnode::num_(double x) {
+ // set number from binary: text (shortest round-trip) is not kept, unless x is integral
+ // and does not print back the same (e.g. 1e+15)
+ Fpconv::Buf buf, ibuf;
+ size_t n = Fpconv::format(x, buf);
+ double d;
+ int64_t i;
+ if(not Fpconv::parse(buf, buf + n, d, i))
+  { drop_text_(); nint_ = false; nd_ = x; return; }
+ if(Fpconv::format(i, ibuf) == n and memcmp(buf, ibuf, n) == 0)
+  return num_(i);
+ memcpy(text_(n), buf, n);
+ nint_ = true;
+ txp_->ni = i;
 }
 
 
-std::ostream & Jnode::print_json_(std::ostream & os, const Jnode & me, long & rl) {
- auto & my = me.value();                                        // resolve if virtual object
+std::ostream & Jnode::print_json_(std::ostream & os, const Jnode & my, long & rl) {
  switch(my.type()) {
   case Object:
         os << JSN_OBJ_OPN;
@@ -1306,9 +1708,13 @@ std::ostream & Jnode::print_json_(std::ostream & os, const Jnode & me, long & rl
   case Null:
         return os << STR_NULL;
   case Number:
-        return os << my.val();
-  case String:
-        return os << JSN_STRQ << my.str() << JSN_STRQ;
+  case String: {
+        Fpconv::Buf buf;
+        size_t n;
+        const char * s = my.text_(buf, n);
+        if(my.type() == Number) return os.write(s, n);
+        return os.put(JSN_STRQ).write(s, n).put(JSN_STRQ);
+       }
   default:
         return os;                                              // ignore unknown type
  }
@@ -1320,12 +1726,13 @@ std::ostream & Jnode::print_iterables_(std::ostream & os, const Jnode & my, long
  // process children in iterables (array or node)
  if(endl_ == PRINT_PRT) ++rl;                                   // if pretty print - adjust level
 
+ size_t left = my.children_().size();
  for(auto & child: my.children_()) {                            // print all children:
   os << std::string(rl * tab_, ' ');                            // output current indent
   if(not my.is_array())                                         // if parent (me) is not Array
    os << JSN_STRQ << child.KEY << JSN_STRQ << ": ";             //  print label
   print_json_(os, child.VALUE, rl)                              // then print child itself and the
-   << (child.KEY != my.children_().rbegin()->KEY? ",": "")      // trailing comma if not the last
+   << (--left > 0? ",": "")                                     // trailing comma if not the last
    << endl_;
  }
 
@@ -1344,6 +1751,7 @@ std::ostream & Jnode::print_iterables_(std::ostream & os, const Jnode & my, long
 class Json {
   friend std::ostream & operator<<(std::ostream & os, const Json & my)
                          { return os << my.root(); }
+    friend class Jnode;                                         // Jnode::materialize_()
 
     #define PARSE_THROW \
                 may_throw, \
@@ -1397,17 +1805,28 @@ class Json {
                 strict_no_trail     /* don't allow anything past json, throw otherwise */
     ENUM(ParseTrailing, PARSETRAILING)
 
+    struct Events {                                             // events for tree-less parsing
+        std::function<void(void)>
+                        begin_object, end_object,
+                        begin_array, end_array,
+                        null;
+        std::function<void(const std::string &)>
+                        label, string, number;
+        std::function<void(bool)>
+                        boolean;
+    };
+
     #define CACHE_STATE \
                 invalidate, \
                 keep_cache
     ENUM(CacheState, CACHE_STATE)
 
-    typedef std::map<std::string, Jnode> map_jn;
+    typedef Jnode::map_jn map_jn;
 
 
                         Json(void) = default;
-                        Json(const Jnode &jn): root_{jn.value()} { }
-                        Json(Jnode &&jn): root_{std::move(jn.value())} { }
+                        Json(const Jnode &jn): root_{jn} { }
+                        Json(Jnode &&jn): root_{std::move(jn)} { }
                         Json(const std::string &str) { parse(str); }
                         Json(const char * c_str) { parse( std::string{c_str} ); }
 
@@ -1421,20 +1840,47 @@ class Json {
                          { return parse(jsi, trail); }
     Json &              parse(std::string::const_iterator & jsi,
                               ParseTrailing trail = relaxed_trailing);
-    std::string::const_iterator
-                        exception_point(void) { return ep_; }
+    Json &              parse(const char * && jsp, ParseTrailing trail = relaxed_trailing)
+                         { return parse(jsp, trail); }
+    Json &              parse(const char * & jsp, ParseTrailing trail = relaxed_trailing);
+    Json &              parse(const char * && jsp, const char * end,
+                              ParseTrailing trail = relaxed_trailing)
+                         { return parse(jsp, end, trail); }
+    Json &              parse(const char * & jsp, const char * end,
+                              ParseTrailing trail = relaxed_trailing);
+    Json &              parse(const std::string & jstr, const Events & ev,
+                              ParseTrailing trail = relaxed_trailing)
+                         { return parse(jstr.c_str(), ev, trail); }
+    Json &              parse(const char * && jsp, const Events & ev,
+                              ParseTrailing trail = relaxed_trailing)
+                         { return parse(jsp, ev, trail); }
+    Json &              parse(const char * & jsp, const Events & ev,
+                              ParseTrailing trail = relaxed_trailing);
+    Json &              parse(const char * && jsp, const char * end, const Events & ev,
+                              ParseTrailing trail = relaxed_trailing)
+                         { return parse(jsp, end, ev, trail); }
+    Json &              parse(const char * & jsp, const char * end, const Events & ev,
+                              ParseTrailing trail = relaxed_trailing);
+    size_t              count(const std::string & jstr, ParseTrailing trail = relaxed_trailing)
+                         { return count(jstr.c_str(), trail); }
+    size_t              count(const char * && jsp, ParseTrailing trail = relaxed_trailing)
+                         { return count(jsp, trail); }
+    size_t              count(const char * & jsp, ParseTrailing trail = relaxed_trailing);
+    std::string::const_iterator                                 // valid only if parsed from string
+                        exception_point(void) { return sb_ + (ep_ - pb_); }
+    const char *        exception_pointer(void) { return ep_; }
     class iterator;
     iterator            walk(const std::string & walk_string = "", CacheState = invalidate);
 
     // relayed Jnode interface
     std::string         to_string(Jnode::PrettyType pt = Jnode::Pretty) const
                          { return root().to_string(pt); }
-    std::string         unquote_str(std::string && src) const;
-    std::string         unquote_str(const std::string & str) const
-                         { std::string src{str}; return unquote_str(std::move(src)); }
-    std::string         inquote_str(std::string && src) const;
-    std::string         inquote_str(const std::string & str) const
-                         { std::string src{str}; return inquote_str(std::move(src)); }
+    std::string         unquote_str(const std::string & src) const
+                         { std::string dst; unquote_str(src, dst); return dst; }
+    std::string &       unquote_str(const std::string & src, std::string & dst) const;
+    std::string         inquote_str(const std::string & src) const
+                         { std::string dst; inquote_str(src, dst); return dst; }
+    std::string &       inquote_str(const std::string & src, std::string & dst) const;
     Jnode::Jtype        type(void) const { return root().type(); }
     Jnode::Jtype &      type(void) { return root().type(); }
     bool                is_object(void) const { return root().is_object(); }
@@ -1449,7 +1895,9 @@ class Json {
     bool                empty(void) const { return root().empty(); }
     bool                has_children(void) const { return root().has_children(); }
     size_t              children(void) const { return root().children(); }
-    Json &              clear(void) { root().clear(); return *this; }
+    size_t              hash(void) const { return root().hash(); }
+    Jnode::Footprint    footprint(void) const;                  // incl. search cache, namespace
+    Json &              clear(void) { uncache_(&root()); root().clear(); return *this; }
     Jnode &             operator[](long i) { return root()[i]; }
     Jnode &             operator[](int i) { return root()[i]; }
     const Jnode &       operator[](long i) const { return root()[i]; }
@@ -1466,16 +1914,17 @@ class Json {
     bool                operator!=(const Json &j) const { return root() != j.root(); }
     bool                operator==(const Jnode &j) const { return root() == j; }
     bool                operator!=(const Jnode &j) const { return root() != j; }
-    const std::string & str(void) const { return root().str(); }
+    std::string         str(void) const { return root().str(); }
     double              num(void) const { return root().num(); }
     bool                bul(void) const { return root().bul(); }
-    const std::string & val(void) const { return root().val(); }
-    Json &              erase(const std::string & l) { root().erase(l); return *this; }
-    Json &              erase(size_t i) { root().erase(i); return *this; }
+    std::string         val(void) const { return root().val(); }
+    Json &              erase(const std::string & l)
+                         { uncache_(&root()); root().erase(l); return *this; }
+    Json &              erase(size_t i) { uncache_(&root()); root().erase(i); return *this; }
     Json &              push_back(Jnode jn)
-                         { root().push_back(std::move(jn)); return *this; }
+                         { uncache_(&root()); root().push_back(std::move(jn)); return *this; }
     Json &              pop_back(void)
-                         { root().pop_back(); return *this; }
+                         { uncache_(&root()); root().pop_back(); return *this; }
 
     Jnode::iterator     begin(void) { return root().begin(); }
   Jnode::const_iterator begin(void) const { return root().begin(); }
@@ -1483,8 +1932,10 @@ class Json {
     Jnode::iterator     end(void) { return root().end(); }
   Jnode::const_iterator end(void) const { return root().end(); }
   Jnode::const_iterator cend(void) const { return root().cend(); }
-    Json &              erase(Jnode::iterator & it) { root().erase(it); return *this; };
-    Json &              erase(Jnode::const_iterator & it) { root().erase(it); return *this; };
+    Json &              erase(Jnode::iterator & it)
+                         { uncache_(&root()); root().erase(it); return *this; };
+    Json &              erase(Jnode::const_iterator & it)
+                         { uncache_(&root()); root().erase(it); return *this; };
     size_t              count(const std::string & l) const { return root().count(l); };
     Jnode::iterator     find(const std::string & l) { return root().find(l); }
   Jnode::const_iterator find(const std::string & l) const { return root().find(l); }
@@ -1502,31 +1953,64 @@ class Json {
     bool                is_solidus_quoted(void) const { return jsn_fbdn_[0] == '/'; }
     Json &              quote_solidus(bool quote)
                          { jsn_fbdn_ = quote? "/" JSN_FBDN: JSN_FBDN; return *this; }
+    bool                is_indexed(void) const { return idx_; }
+    Json &              indexed(bool x = true) { idx_ = x; return *this; }
+    bool                is_lazy(void) const { return lzy_; }
+    Json &              lazy(bool x = true) { lzy_ = x; return *this; }
+    size_t              concurrency(void) const { return thr_; }
+    Json &              concurrent(size_t n = std::thread::hardware_concurrency())
+                         { thr_ = n; return *this; }
     Json &              clear_cache(void) { sc_.clear(); return *this; }
+    Json &              clear_cache(const iterator & it);       // cache affected by it's change
     const map_jn &      ns(void) const { return jns_; }         // namespace
     Json &              clear_ns(const std::string &s = "")     // clear namespace
                          { if(s.empty()) jns_.clear(); else jns_.erase(s); return *this; }
 
-    // calling clear_cache is required once JSON was modified anyhow; it's called
-    // anyway every time a new walk is build, thus the end-user must call it only
-    // when continue walking iterators (with search iterators) past JSON modification
+    // the search cache is invalidated every time a new walk is built (unless walked with
+    // keep_cache): modifications via walk iterators (their super nodes) or via Json's
+    // relayed interface drop only the cache they could affect; once JSON was modified
+    // otherwise (e.g. via Jnode & handed out), either the affected part must be told by
+    // clear_cache(it) (it - walk iterator pointing to the modified node), or the entire
+    // cache be cleared - clear_cache(), before walking with keep_cache
 
     //SERDES(root_)                                             // not really needed (so far)
     DEBUGGABLE()
     EXCEPTIONS(Jnode::ThrowReason)
 
-    static Jnode::Jtype json_number_definition(std::string::const_iterator & jsp);
+    static Jnode::Jtype json_number_definition(std::string::const_iterator & jsi);
+    static Jnode::Jtype json_number_definition(const char * & jsp, const char * end = nullptr);
     static size_t utf8_adjusted(size_t start, const std::string &jsrc, size_t end = -1);
     static size_t byte_offset(const std::string &jsrc, size_t utf8_offset);
 
 
  protected:
     // protected data structures
+    struct Clabel {                                             // label of a counted object
+        const char *        begin, * end;
+        size_t              size;                               // size of label's value
+    };
+
     Jnode               root_;                                  // underlying JSON structure
+    const char *        ep_{nullptr};                           // exception pointer
     std::string::const_iterator
-                        ep_;                                    // exception pointer
+                        sb_;                                    // string begin (when parsing
+    const char *        pb_{nullptr};                           // string), and its char pointer
+    const char *        pe_{nullptr};                           // input end (if not NUL terminated)
     const char *        jsn_fbdn_{JSN_FBDN};                    // JSN_FBDN pointer
     const char *        jsn_qtd_{JSN_QTD};                      // JSN_QTD pointer
+    bool                idx_{false};                            // two-stage parsing (indexed)
+    Sindex *            six_{nullptr};                          // structural index (when parsing)
+    Symtab *            st_{nullptr};                           // labels table (when parsing)
+    size_t              thr_{1};                                // threads parsing top iterable
+    bool                lzy_{false};                            // lazy parsing
+    bool                dfr_{false};                            // defer nested iterables (lazy)
+    bool                vld_{true};                             // validate deferred iterables
+    std::string         evs_;                                   // event value (reused buffer)
+    size_t              cnt_{0};                                // nodes counted by event parsing
+    bool                cnt_dup_{false};                        // discount duplicate labels
+    std::deque<std::vector<Clabel>>
+                        clv_;                                   // labels of counted objects
+    size_t              cld_{0};                                // (per nesting level)
     map_jn              jns_;                                   // jnode name space
     const Jnode *       ujn_ptr_;                               // for is_unique_()
     const Jnode *       djn_ptr_;                               // for is_duplicate_()
@@ -1534,23 +2018,44 @@ class Json {
 
  private:
     struct WalkStep;                                            // fwd decl.
+    struct Jspan {                                              // span of top-level elements
+        const char *        begin, * end;                       // (concurrent parsing)
+        std::vector<Symbol> labels;                             // (objects only)
+        std::vector<Jnode>  values;
+    };
 
     auto                end_(void) { return root().children_().end(); } // frequently used shortcut
-    void                parse_(Jnode & node, std::string::const_iterator &jsp);
-    void                parse_bool_(Jnode & node, std::string::const_iterator &jsp);
-    void                parse_string_(Jnode & node, std::string::const_iterator &jsp);
-    void                parse_number_(Jnode & node, std::string::const_iterator &jsp);
-    void                parse_array_(Jnode & node, std::string::const_iterator &jsp);
-    void                parse_object_(Jnode & node, std::string::const_iterator &jsp);
-    char                skip_blanks_(std::string::const_iterator & jsp);
-    Jnode::Jtype        classify_jnode_(std::string::const_iterator & jsp);
-    std::string::const_iterator &
-                        find_delimiter_(char c, std::string::const_iterator & jsp);
-    std::string::const_iterator &
-                        validate_number_(std::string::const_iterator & jsp);
-
-    typedef map_jn::iterator iter_jn;
-    typedef map_jn::const_iterator const_iter_jn;
+    void                parse_(Jnode & node, const char * &jsp);
+    void                parse_bool_(Jnode & node, const char * &jsp);
+    void                parse_string_(Jnode & node, const char * &jsp);
+    void                parse_number_(Jnode & node, const char * &jsp);
+    void                parse_array_(Jnode & node, const char * &jsp);
+    void                parse_object_(Jnode & node, const char * &jsp);
+    void                parse_trailing_(const char * &jsp, ParseTrailing trail);
+    Symbol              intern_(const Jnode & label) {
+                         size_t n;
+                         const char * s = label.chars_(n);
+                         return st_ == nullptr? Symbol{std::string{s, n}}: st_->intern(s, n);
+                        }
+    bool                parse_concurrently_(const char * &jsp);
+    void                parse_span_(Jspan & span, Jnode::Jtype jt);
+    void                defer_iterable_(Jnode & node, const char * &jsp);
+    static const char * skip_iterable_(const char * jsp);
+    Jnode::Jtype        parse_event_(const Events & ev, const char * &jsp);
+    void                parse_array_events_(const Events & ev, const char * &jsp);
+    void                parse_object_events_(const Events & ev, const char * &jsp);
+    void                discount_duplicates_(std::vector<Clabel> & lv);
+    char                skip_blanks_(const char * & jsp);
+    Jnode::Jtype        classify_jnode_(const char * & jsp);
+    const char * &      find_delimiter_(char c, const char * & jsp);
+    bool                is_end_(const char * jsp) const { return jsp == pe_ or *jsp == CHR_NULL; }
+    static const char * skip_plain_chars_(const char * jsp, char c, char s,
+                                          const char * end = nullptr);
+    static const char * unquote_u_(const char * sp, const char * end, std::string & dst);
+    const char * &      validate_number_(const char * & jsp);
+
+    typedef Jnode::iter_jn iter_jn;
+    typedef Jnode::const_iter_jn const_iter_jn;
     typedef std::vector<std::string> vec_str;
 
     void                compile_walk_(const std::string & wstr, iterator & it) const;
@@ -1573,23 +2078,26 @@ class Json {
     struct Itr {
         // path-vector is made of Itr - result of walking WalkStep vector (walk path)
         // last Itr in path-vector points to the found JSON element (via jit)
-        // lbl and jnp keep a copy of jit's key and Jnode addr: this is required for
-        // validation - jit could be invalidated due to a prior JSON manipulation,
-        // preserved lbl and jnode addr ensure safe execution of is_nested() and
-        // is_valid() methods;
-        // wsi (filled only when path is terminated with end() - out of iterations/non
-        // iterable) used in increment_() facilitating walk path iterations
+        // jit could be invalidated due to a prior JSON manipulation, hence validation
+        // (is_valid()) relies on the epoch of jit's container: if the container still
+        // holds jit in the same epoch (no child was erased since), jit is valid for sure;
+        // otherwise the Jnode (addr jnp) is looked up by the label (index) - lbl (idx);
+        // is_nested() compares Jnode addresses only
 
                             Itr(void) = default;                // for pv_.resize()
                             Itr(const iter_jn &it):             // for emplacement of good itr
-                             jit(it), lbl(it->KEY), jnp(&it->VALUE) {}
+                             jit(it), lbl(it->KEY), jnp(&it->VALUE),
+                             epoch(Jnode::desc_jn::epoch(it))
+                             { if(it.is_indexed()) idx = it.index(); }
                             Itr(const iter_jn &it, bool x):     // for emplacement of endl() only!
                              jit(it) {}
 
-        // typedef std::map<std::string, Jnode>::iterator iter_jn;
+        // typedef Descendants<Jnode>::iterator iter_jn;
         iter_jn             jit;                                // iterator pointing to JSON
-        std::string         lbl;                                // label and node ptr are required
-        const Jnode *       jnp{nullptr};                       // for iterator (jit) validation
+        Symbol              lbl{nullptr};                       // label (index) and node ptr
+        size_t              idx{0};                             // are required for validation
+        const Jnode *       jnp{nullptr};                       // of iterator (jit)
+        uint64_t            epoch{0};                           // of jit's container (pinned)
     };
     typedef std::vector<Itr> path_vector;                       // used by iterator, CahceEntry
 
@@ -1687,7 +2195,7 @@ class Json {
                               throw j.EXP(Jnode::walk_non_existant_namespace);
                              if(found->VALUE.type() != Jnode::Number)   // value is not a number
                               throw j.EXP(Jnode::walk_non_numeric_namespace);
-                             long x =  strtol(found->VALUE.val().c_str(), nullptr, 10 );
+                             long x = found->VALUE.integer();
                              if(x < 0 and not is_tag_based())   // only t/l can go negative
                               throw j.EXP(Jnode::walk_negative_quantifier); // quant cannot be neg.
                              return x;
@@ -1705,6 +2213,8 @@ class Json {
         vec_str             stripped;
                             // stripped[0] -> a stripped lexeme (required)
                             // stripped[1] -> attached label match (optional)
+        std::vector<Symbol> symbols;                            // stripped, as symbols (match
+                                                                // against labels)
         std::regex          re;                                 // RE for R/L/D suffixes
         Jnode               user_json{Jnode::Neither};          // Json for <>j, or <>v assignment
         path_vector         fs_path;
@@ -1756,7 +2266,9 @@ class Json {
         // Search may occur off any JSON node and in any of WalkSteps, hence a unique
         // key would be their combination
         // WalkStep (ws) needs to be preserved (cannot be referenced) as the original
-        // walk path might not even exist, while cache could be still alive and actual
+        // walk path might not even exist, while cache could be still alive and actual;
+        // origin (path to jnp, not a part of the key) tells if the key is still actual:
+        // jnp might be a reused address of a node, which has replaced an erased one
 
                             SearchCacheKey(void) = delete;
                             SearchCacheKey(const Jnode *jp, const WalkStep & w):
@@ -1764,15 +2276,23 @@ class Json {
 
         const Jnode *       json_node(void) const { return jnp; }   // only for COUTABLE
 
-        static bool         cmp(const SearchCacheKey &l, const SearchCacheKey &r)
-                             { return l.jnp != r.jnp? l.jnp<r.jnp: l.ws<r.ws; }
+        struct Cmp {                                            // keys could be found by jnp too
+            typedef void        is_transparent;
+            bool                operator()(const SearchCacheKey &l, const SearchCacheKey &r) const
+                                 { return l.jnp != r.jnp? l.jnp<r.jnp: l.ws<r.ws; }
+            bool                operator()(const SearchCacheKey &l, const Jnode *r) const
+                                 { return l.jnp < r; }
+            bool                operator()(const Jnode *l, const SearchCacheKey &r) const
+                                 { return l < r.jnp; }
+        };
 
         const Jnode *       jnp;
         WalkStep            ws;
+        path_vector         origin;                             // set when cache is built
 
         COUTABLE(SearchCacheKey, json_node(), ws)
     };
-    typedef std::map<SearchCacheKey, std::vector<CacheEntry>, decltype(&SearchCacheKey::cmp)>
+    typedef std::map<SearchCacheKey, std::vector<CacheEntry>, SearchCacheKey::Cmp>
                         SeachCache;
 
 
@@ -1786,14 +2306,13 @@ class Json {
     // Json::iterator (a.k.a. walk iterator): needs to be defined in-class to facilitate
     // container storage with the iterator (e.g. walk-based callbacks)
     //
-    class iterator: public std::iterator<std::forward_iterator_tag, Jnode> {
+    class iterator: public std::iterator<std::forward_iterator_tag, Jnode::SuperJnode> {
      // this forward iterator let iterating over *iterable* walk paths
-     // once iterator is dereferenced it returns a reference to a Jnode's super-node,
-     // super-node adds following powers to regular Jnode:
+     // once iterator is dereferenced it returns a reference to a super-node (a view of
+     // the walked Jnode), super-node adds following powers to regular Jnode's interface:
      // - label() allows accessing node's label if node is nested by object
      // - index() allows accessing node's ordinal index if nested by array
-     // - value() provides access to the Jnode itself (but this methods is quite
-     //   redundant)
+     // - value() provides access to the Jnode itself
      // - is_root() let checking if the node is root() or not
      // - operator[] receives a new capability: on a negative index it will address
      //              indexed levels up in the JSON's tree hierarchy (e.g." [-1] will
@@ -1807,68 +2326,90 @@ class Json {
                              swap(l.sn_.parent_type(), r.sn_.parent_type());// supernode requires
                             }                                   // swapping of type_ values only
 
+     public:
         // walk iterator's Super node class definition
         //
-        class SuperJnode: public Jnode {
+        class SuperJnode: public Jnode::SuperJnode {
             friend Json::iterator;
+            friend void         swap(SuperJnode & l, SuperJnode & r)    // swaps nodes
+                                 { l.modified_(); r.modified_(); swap(l.value(), r.value()); }
 
          public:
+            explicit            SuperJnode(const Jnode & jn): Jnode::SuperJnode{jn} {}
+                                SuperJnode(const SuperJnode &) = default;
+            SuperJnode &        operator=(const SuperJnode & sn)
+                                 { modified_(); value() = sn.value(); return *this; }
+            SuperJnode &        operator=(Jnode jn)
+                                 { modified_(); value() = std::move(jn); return *this; }
+
+            // mutators drop search cache affected by the change (see Json::clear_cache)
+            Jnode &             clear(void) { modified_(); return value().clear(); }
+            Jnode &             erase(const std::string & l) { modified_(); return value().erase(l); }
+            Jnode &             erase(size_t i) { modified_(); return value().erase(i); }
+            Jnode &             erase(Jnode::iterator & it) { modified_(); return value().erase(it); }
+            Jnode &             erase(Jnode::const_iterator & it)
+                                 { modified_(); return value().erase(it); }
+            Jnode &             erase(Jnode::const_iterator && it)
+                                 { modified_(); return value().erase(std::move(it)); }
+            Jnode &             push_back(Jnode jn)
+                                 { modified_(); return value().push_back(std::move(jn)); }
+            Jnode &             pop_back(void) { modified_(); return value().pop_back(); }
+
             bool                has_label(void) const {
-                                 return lbl_ != &Json::iterator::empty_lbl_ and
-                                        parent_type() == Object;
-                                }
-            const std::string & label(void) const {
-                                 if(type_ != Object)
-                                  throw EXP(label_request_for_non_object_enclosed);
-                                 return *lbl_;
+                                 if(not via_) throw jnp_->EXP(Jnode::label_accessed_not_via_iterator);
+                                 return lbp_ != nullptr and lbp_ != &Json::iterator::empty_lbl_ and
+                                        ptype_ == Jnode::Object;
                                 }
             bool                has_index(void) const {
-                                 return lbl_ != &Json::iterator::empty_lbl_ and
-                                        parent_type() == Array;
+                                 if(not via_) throw jnp_->EXP(Jnode::index_accessed_not_via_iterator);
+                                 return lbp_ == nullptr and ptype_ == Jnode::Array;
                                 }
-            int64_t             index(void) const {
-                                 if(type_ != Array)
-                                  throw EXP(index_request_for_non_array_enclosed);
-                                 return std::stoul(lbl_->c_str(), nullptr, 16);
+            bool                is_root(void) const {
+                                 if(not via_) throw jnp_->EXP(Jnode::method_accessed_not_via_iterator);
+                                 return &jit_->jp_->root() == jnp_;
                                 }
-            Jnode &             value(void) { return *jnp_; }
-            const Jnode &       value(void) const { return *jnp_; }
-            bool                is_root(void) const { return &jit_->jp_->root() == jnp_; }
+            using               Jnode::SuperJnode::operator[];
             Jnode &             operator[](long i) {
                                  // in addition to Jnode::iterator's, this one adds capability
                                  // to address supernode with negative index, e.g: [-1],
                                  // like in the walk-string to reference a parent
-                                 if(i >= 0) return Jnode::operator[](i);
+                                 if(i >= 0) return value()[i];
                                  return -i >= static_cast<long>(jit_->pv_.size())?
                                         jit_->json().root():
                                         jit_->pv_[jit_->pv_.size() + i -1].jit->VALUE;
                                 }
+            Jnode &             operator[](int i)
+                                 { return operator[](static_cast<long>(i)); }
             const Jnode &       operator[](long i) const {
-                                 if(i >= 0) return Jnode::operator[](i);
+                                 if(i >= 0) return cnode_()[i];
                                  return -i >= static_cast<long>(jit_->pv_.size())?
                                         jit_->json().root():
                                         jit_->pv_[jit_->pv_.size() + i -1].jit->VALUE;
                                 }
-            Jtype               parent_type(void) const { return type_; }
-            Jtype &             parent_type(void) { return type_; }
-                                // this is a work around GNU's compiler bug-limitation, which
-                                // does not extend scoping onto subclasses, i.e.:
-                                // swap(l.sn_.type_, r.sn_.type_) fails.
+            const Jnode &       operator[](int i) const
+                                 { return operator[](static_cast<long>(i)); }
 
          private:
-                                SuperJnode(Jnode::Jtype t = Jnode::Neither): Jnode{t} {}
+                                SuperJnode(Jnode::Jtype t = Jnode::Neither):
+                                 Jnode::SuperJnode{t} { lbp_ = &Json::iterator::empty_lbl_; }
 
-            SuperJnode &        operator()(const std::string &l, Jnode &jn, Json::iterator * jit)
-                                 { lbl_ = &l; jnp_ = &jn; jit_ = jit; return *this; }
+            SuperJnode &        operator()(const iter_jn &it, Jnode &jn, Json::iterator * jit) {
+                                 if(it.is_indexed()) { lbp_ = nullptr; idx_ = it.index(); }
+                                 else lbp_ = &it->KEY.str();
+                                 jnp_ = &jn;
+                                 jit_ = jit;
+                                 return *this;
+                                }
             SuperJnode &        operator()(Jnode &jn, Json::iterator * jit) {
-                                 lbl_ = &Json::iterator::empty_lbl_;
+                                 lbp_ = &Json::iterator::empty_lbl_;
                                  jnp_ = &jn;
                                  jit_ = jit;
                                  return *this;
                                 }
 
-            const std::string * lbl_{&Json::iterator::empty_lbl_}; // lbl_ should never be nullptr
-            Jnode *             jnp_{nullptr};                  // iterator's Jnode pointer
+            void                modified_(void)                 // viewed node is being modified
+                                 { if(jit_ != nullptr) jit_->json().clear_cache(*jit_); }
+
             Json::iterator *    jit_{nullptr};                  // back to iterator, for [-n]
         };
         //
@@ -1878,7 +2419,7 @@ class Json {
                             iterator(void) = default;           // DC
                             iterator(const iterator &it):       // CC
                              ws_(it.ws_), pv_(it.pv_), jp_(it.jp_) {
-                             sn_.type_ = it.sn_.type_;
+                             sn_.parent_type() = it.sn_.parent_type();
                             }
                             iterator(iterator &&it) {           // MC
                              swap(*this, it);
@@ -1892,12 +2433,12 @@ class Json {
                             operator Jnode::iterator (void) const {
                              auto it = pv_.empty()?
                                        jp_->root().children_().begin(): pv_.back().jit;
-                             return Jnode::iterator{std::move(it), sn_.type_};
+                             return Jnode::iterator{std::move(it), sn_.parent_type()};
                             }
                             operator Jnode::const_iterator(void) const {
                              auto it = pv_.empty()?
                                        jp_->root().children_().begin(): pv_.back().jit;
-                             return Jnode::const_iterator{std::move(it), sn_.type_};
+                             return Jnode::const_iterator{std::move(it), sn_.parent_type()};
                             }
 
         bool                operator==(const iterator & rhs) const {
@@ -1916,30 +2457,31 @@ class Json {
         template<typename T>
         bool                operator!=(const T & rhs) const
                              { return not operator==(rhs); }
-        Jnode &             operator*(void) {
+        SuperJnode &        operator*(void) {
                              if(not ws_.empty() and ws_.back().jsearch == key_of_value) {
-                              // return value of label/index in the supernode's JSON
+                              // return value of label/index in the supernode's JSON (kn_),
+                              // the key node itself has neither label, nor index
                               if(pv_.empty()) throw jp_->EXP(Jnode::walk_root_has_no_label);
-                              switch (sn_.type_) {
+                              switch (sn_.parent_type()) {
                                case Jnode::Object:
-                                     sn_.type_ = Jnode::String;
-                                     sn_.value_ = pv_.back().jit->KEY;
+                                     kn_.type_ = Jnode::String;
+                                     kn_.str_(pv_.back().jit->KEY.c_str(),
+                                              pv_.back().jit->KEY.size());
                                      break;
                                case Jnode::Array:
-                                     sn_.type_ = Jnode::Number;
-                                     sn_.value_ = std::to_string(
-                                                   std::stol(pv_.back().jit->KEY, nullptr, 16));
+                                     kn_.type_ = Jnode::Number;
+                                     kn_.num_(static_cast<int64_t>(pv_.back().jit.index()));
                                      break;
                                default:
                                      break;
                               }
-                              return sn_(pv_.back().jit->KEY, static_cast<Jnode&>(sn_), this);
+                              return sn_(kn_, this);
                              }
                              return pv_.empty()?
                               sn_(jp_->root(), this):
-                              sn_(pv_.back().jit->KEY, pv_.back().jit->VALUE, this);
+                              sn_(pv_.back().jit, pv_.back().jit->VALUE, this);
                             }
-        Jnode *             operator->(void)
+        SuperJnode *        operator->(void)
                              { return & operator*(); }
         iterator &          operator++(void)
                              { incremented(); return *this; }
@@ -2002,7 +2544,8 @@ class Json {
       std::vector<WalkStep> ws_;                                // walk state vector (walk path)
         path_vector         pv_;                                // path_vector (result of walking)
         Json *              jp_;                                // json pointer (for json().end())
-        SuperJnode          sn_{Jnode::Neither};                // super node type_ holds parent's
+        SuperJnode          sn_{Jnode::Neither};                // super node (holds parent's type)
+        Jnode               kn_{Jnode::Neither};                // key node (for key_of_value)
 
      private:
         #define SEARCH_TYPE \
@@ -2015,47 +2558,48 @@ class Json {
         const std::vector<WalkStep> &
                             walk_path_(void) const { return ws_; }
         //Json &              json_(void) const { return *jp_; }
-        auto &              sn_type_ref_(void) { return sn_.type_; }    // original container type
+        auto &              sn_type_ref_(void) { return sn_.parent_type(); }    // original container type
 
         size_t              walk_(void);
         void                walk_step_(size_t wsi, Jnode *);
         void                show_built_pv_(std::ostream &out) const;
         void                walk_numeric_offset_(size_t wsi, Jnode *);
-        Json::iter_jn       build_cache_(Jnode *jn, size_t wsi);
         void                walk_text_offset_(size_t wsi, Jnode *);
         void                walk_search_(size_t wsi, Jnode *);
         size_t              normalize_(long offset, Jnode *jn) const {  // norm. by [jn->chldrn]
-                             long children = static_cast<long>(jn->children_().size());
+                             long children = static_cast<long>(jn->children());
                              if(offset >= 0) return offset > children? children: offset;
                              return children + offset < 0? 0: children + offset;
                             }
         long                re_normalize_(long offset, Jnode *jn) const {   // relative normalize
-                             long children = static_cast<long>(jn->children_().size());
+                             long children = static_cast<long>(jn->children());
                              return offset > children? children:
                                     -offset > children? -children: offset;
                             }
 
         void                research_(Jnode *jn, size_t wsi,
                                       std::vector<Json::CacheEntry> *, SearchCacheKey *);
-        bool                re_search_(Jnode *jn, WalkStep &, const char *lbl, long &instance,
+        bool                re_search_(Jnode *jn, WalkStep &, const Symbol *lbl, long &instance,
                                        long cf, SearchType st, std::vector<Json::CacheEntry> *);
         bool                build_cache_(long &instance, long cf, std::vector<Json::CacheEntry> *);
-        bool                match_iterable_(Jnode *jn, const char *lbl, const WalkStep &);
-        bool                atomic_match_(const Jnode *jn, const char *lbl,
+        void                pin_path_(path_vector & pv, size_t from);
+        bool                is_origin_(const path_vector & origin) const;
+        bool                match_iterable_(Jnode *jn, const Symbol *lbl, const WalkStep &);
+        bool                atomic_match_(const Jnode *jn, const Symbol *lbl,
                                           const WalkStep &ws, map_jn * ns);
         bool                string_match_(const Jnode *jn, const WalkStep &, map_jn * ns) const;
         bool                regex_match_(const std::string &val, const WalkStep &, map_jn *) const;
-        bool                label_match_(map_jn::iterator jit, const Jnode *jn, long idx,
+        bool                label_match_(iter_jn jit, const Jnode *jn, long idx,
                                          WalkStep & ws, map_jn * ns) const;
         bool                bull_match_(const Jnode *jn, const WalkStep &) const;
         bool                is_unique_(const Jnode & jn, const WalkStep &ws);
         bool                is_duplicate_(const Jnode & jn, const WalkStep &ws);
         void                purge_ns_(const std::string & pfx);
 
-        void                lbl_callback_(const char *lbl,
+        void                lbl_callback_(const std::string &lbl,
                                           const std::vector<Json::CacheEntry> * = nullptr);
         void                wlk_callback_(const Jnode *);
-        void                dmx_callback_(const Jnode *, const char *lbl,
+        void                dmx_callback_(const Jnode *, const Symbol *lbl,
                                           const std::vector<Json::CacheEntry> * = nullptr);
 
         bool                increment_(long wsi);
@@ -2090,10 +2634,18 @@ class Json {
      //      key: made of { WalkStep, *Jnode };
      //      value: vector<CacheEntry: { namespace (map_jn); vector<path_vector> }>;
      // - namespace is required to be a part of the cache to support REGEX values only!
-    SeachCache          sc_{SearchCacheKey::cmp};           // search cache itself
+    SeachCache          sc_;                                // search cache itself
                         // search cache is the array of all path_vector's for given
                         // search key (combination of jnode and walk step)
 
+    void                uncache_(const Jnode *jnp) {            // drop searches off the node
+                         auto found = sc_.equal_range(jnp);
+                         sc_.erase(found.first, found.second);
+                        }
+    static size_t       footprint_(const map_jn & ns, std::unordered_set<const void *> & seen);
+
+
+    typedef std::function<void(const iterator::SuperJnode &)> callback_fn; // gets a super node
 
     struct WlkCallback {
      // this class facilitates wlk_callback_vec type storage, binding Json::iterator
@@ -2101,15 +2653,14 @@ class Json {
      // There are 2 types of callbacks:
      // 1. callback hooked onto the JSON labels (lbl_callback_map)
      // 2. callback hooked onto Json::iterators (wlk_callback_vec)
-                            WlkCallback(iterator &&itr, std::function<void(const Jnode &)> &&cb):
+                            WlkCallback(iterator &&itr, callback_fn &&cb):
                              itr{std::move(itr)}, callback(std::move(cb)) {}
         iterator            itr;
-        std::function<void(const Jnode &)>
-                            callback;
+        callback_fn         callback;
     };
 
 
-    typedef std::map<std::string, std::function<void(const Jnode &)>> lbl_callback_map;
+    typedef std::map<std::string, callback_fn> lbl_callback_map;
     typedef std::vector<WlkCallback> wlk_callback_vec;
 
     lbl_callback_map    lcb_;                                   // label callbacks storage
@@ -2132,12 +2683,12 @@ class Json {
     Json &              engage_callbacks(bool x=true)           // engage/disengage all callbacks
                          { ce_ = x; return *this; };
     Json &              callback(const std::string &lbl,        // plug-in label-callback
-                                 std::function<void(const Jnode &)> &&cb) {
+                                 callback_fn &&cb) {
                          lcb_.emplace(std::move(lbl), std::move(cb));
                          return *this;
                         }
     Json &              callback(iterator itr,                  // plug-in iter-callback (from walk)
-                                 std::function<void(const Jnode &)> &&cb) {
+                                 callback_fn &&cb) {
                          if(itr != itr.end())                   // don't plug ended iterators
                           wcb_.emplace_back(std::move(itr), std::move(cb));
                          return *this;
@@ -2180,38 +2731,298 @@ Json operator ""_json(const char *c_str, std::size_t len) {
 
 
 
-Json & Json::parse(std::string::const_iterator & jsp, ParseTrailing trail) {
- // parse input string. this is a wrapper for parse_(), where actual parsing occurs
+Json & Json::parse(std::string::const_iterator & jsi, ParseTrailing trail) {
+ // parse input string: parsing occurs directly over string's underlying char buffer
+ sb_ = jsi;                                                     // preserve string's begin for
+ pb_ = &*jsi;                                                   // exception_point()
+ const char * jsp = pb_;
+ parse(jsp, trail);
+ jsi += jsp - pb_;
+ return *this;
+}
+
+
+
+Json & Json::parse(const char * & jsp, ParseTrailing trail) {
+ // parse NUL-terminated input. this is a wrapper for parse_(), where actual parsing occurs
+ // when indexed, parsing occurs in two stages: structural index is built (lazily) first,
+ // then the tree is built using the index
+ Sindex six;
+ GUARD(six_)
+ six_ = idx_? &six.reset(jsp, jsn_fbdn_, jsn_qtd_, pe_): nullptr;
+ Symtab st;                                                     // labels are interned per
+ GUARD(st_)                                                     // parsed document
+ st_ = &st;
+
  root() = OBJ{};
- parse_(root_, jsp);
+ if(thr_ < 2 or not parse_concurrently_(jsp))
+  parse_(root_, jsp);
 
  if(root_.type() == Jnode::Neither)
   { ep_ = jsp; throw EXP(Jnode::expected_json_value); }
 
- if(trail == relaxed_no_trail) return *this;
+ parse_trailing_(jsp, trail);
+ return *this;
+}
+
+
+
+Json & Json::parse(const char * & jsp, const Events & ev, ParseTrailing trail) {
+ // parse NUL-terminated input calling events instead of building the tree;
+ // the tree (root) is left intact
+ Sindex six;
+ GUARD(six_)
+ six_ = idx_? &six.reset(jsp, jsn_fbdn_, jsn_qtd_, pe_): nullptr;
+
+ if(parse_event_(ev, jsp) == Jnode::Neither)
+  { ep_ = jsp; throw EXP(Jnode::expected_json_value); }
+
+ parse_trailing_(jsp, trail);
+ return *this;
+}
+
+
+
+size_t Json::count(const char * & jsp, ParseTrailing trail) {
+ // validate input w/o building the tree, return number of its nodes (i.e. as size() would);
+ // the tree (root) is left intact
+ static const Events none;
+ GUARD(cnt_dup_)
+ cnt_dup_ = true;
+ cnt_ = 1;                                                      // root
+ cld_ = 0;
+ parse(jsp, none, trail);
+ return cnt_;
+}
+
+
+
+Json & Json::parse(const char * & jsp, const char * end, ParseTrailing trail) {
+ // parse input [jsp, end): it's not required to be NUL terminated (a NUL within the
+ // range still terminates it though)
+ GUARD(pe_)
+ pe_ = end;
+ return parse(jsp, trail);
+}
+
+
+
+Json & Json::parse(const char * & jsp, const char * end, const Events & ev,
+                   ParseTrailing trail) {
+ // parse input [jsp, end) calling events
+ GUARD(pe_)
+ pe_ = end;
+ return parse(jsp, ev, trail);
+}
+
+
+
+void Json::parse_trailing_(const char * &jsp, ParseTrailing trail) {
+ // process input past parsed json as per trailing mode
+ if(trail == relaxed_no_trail) return;
  if(trail == strict_no_trail)
-  if(*jsp != CHR_NULL)
+  if(not is_end_(jsp))
    { ep_ = jsp; throw EXP(Jnode::unexpected_trailing); }
 
- for(; *jsp != CHR_NULL; ++jsp) {
+ for(; not is_end_(jsp); ++jsp) {
   if(*jsp > 0 and *jsp <= ' ') continue;
   if(trail == strict_trailing)
    { ep_ = jsp; throw EXP(Jnode::unexpected_trailing); }
   break;
  }
+}
 
- return *this;
+
+bool Json::parse_concurrently_(const char * &jsp) {
+ // parse top-level iterable concurrently: this thread pre-scans the input splitting it at
+ // top-level commas into spans (of JSN_PSPAN bytes at least), worker threads parse spans
+ // into separate subtrees, which then are spliced into the root in order.
+ // return false if concurrent parsing is not applicable (not an iterable, too small), or
+ // if the input is malformed: then sequential parsing takes over (and throws as usual)
+ const char * sp = jsp;
+ while(sp != pe_ and *sp > 0 and *sp <= ' ') ++sp;
+ if(sp == pe_) return false;
+ Jnode::Jtype jt = *sp == JSN_ARY_OPN? Jnode::Array:
+                   *sp == JSN_OBJ_OPN? Jnode::Object: Jnode::Neither;
+ if(jt == Jnode::Neither) return false;
+
+ std::deque<Jspan> spans;                                       // parsed spans, in order
+ size_t next{0};                                                // next span to parse
+ bool scanned{false};
+ std::atomic<bool> failed{false};                               // (modified under the lock)
+ std::mutex mtx;
+ std::condition_variable cv;
+ std::vector<std::thread> pool;
+
+ auto worker = [&](void) {
+  Json wj;                                                      // own parser's state
+  Symtab st;
+  wj.st_ = &st;
+  wj.jsn_fbdn_ = jsn_fbdn_;
+  wj.jsn_qtd_ = jsn_qtd_;
+  wj.idx_ = idx_;
+  wj.pe_ = pe_;
+  wj.lzy_ = wj.dfr_ = lzy_;                                     // spans hold root's children
+  while(true) {
+   Jspan * span;
+   {
+    std::unique_lock<std::mutex> lck(mtx);
+    cv.wait(lck, [&]{ return failed or scanned or next < spans.size(); });
+    if(failed or next >= spans.size()) return;
+    span = &spans[next++];
+   }
+   try { wj.parse_span_(*span, jt); }
+   catch(...) {
+    { std::lock_guard<std::mutex> lck(mtx); failed = true; }
+    cv.notify_all();
+    return;
+   }
+  }
+ };
+ auto dispatch = [&](const char * begin, const char * end) {
+  {
+   std::lock_guard<std::mutex> lck(mtx);
+   spans.push_back(Jspan{begin, end, {}, {}});
+  }
+  if(pool.size() < thr_) pool.emplace_back(worker);             // workers start lazily
+  cv.notify_one();
+ };
+ auto finish = [&](bool fail) {
+  { std::lock_guard<std::mutex> lck(mtx); scanned = true; if(fail) failed = true; }
+  cv.notify_all();
+  for(auto & th: pool) th.join();
+  return not failed;
+ };
+
+ const char * bp = ++sp;                                        // span begin
+ size_t depth = 1;
+ for(; depth > 0; ++sp) {
+  if(sp == pe_) return finish(true);                            // unbalanced iterable
+  switch(*sp) {
+   case JSN_STRQ:
+        for(++sp; is_end_(sp = skip_plain_chars_(sp, JSN_STRQ, JSN_STRQ, pe_)) or
+                  *sp != JSN_STRQ; ++sp)
+         if(is_end_(sp) or (*sp == CHR_QUOT and is_end_(++sp)))
+          return finish(true);                                  // unterminated string
+        break;
+   case JSN_OBJ_OPN: case JSN_ARY_OPN: ++depth; break;
+   case JSN_OBJ_CLS: case JSN_ARY_CLS: --depth; break;
+   case JSN_ASPR:
+        if(depth == 1 and sp - bp >= JSN_PSPAN) {
+         dispatch(bp, sp);
+         bp = sp + 1;
+         if(failed) return finish(true);
+        }
+        break;
+   case CHR_NULL: return finish(true);                          // unbalanced iterable
+  }
+ }
+ if(sp[-1] != (jt == Jnode::Array? JSN_ARY_CLS: JSN_OBJ_CLS))
+  return finish(true);
+ if(spans.empty()) return false;                                // too small, parse sequentially
+ dispatch(bp, sp - 1);
+ if(not finish(false)) return false;
+
+ root_.type_ = jt;
+ auto & children = root_.children_unpinned_();
+ for(auto & span: spans)
+  for(size_t i = 0; i < span.values.size(); ++i)
+   if(jt == Jnode::Array)
+    children.append(std::move(span.values[i]));
+   else
+    children.append(std::move(span.labels[i]), std::move(span.values[i]));
+ if(jt == Jnode::Object) children.sort();
+ DBG(1) DOUT() << "parsed concurrently " << spans.size() << " spans" << std::endl;
+ jsp = sp;
+ return true;
+}
+
+
+void Json::parse_span_(Jspan & span, Jnode::Jtype jt) {
+ // parse span of top-level elements: "value, value, ..." ("label: value, ..." for objects)
+ Sindex six;
+ GUARD(six_)
+ six_ = idx_? &six.reset(span.begin, jsn_fbdn_, jsn_qtd_, pe_): nullptr;
+
+ for(const char * jsp = span.begin; true; ++jsp) {
+  if(jt == Jnode::Object) {
+   Jnode label;
+   parse_(label, jsp);
+   if(not label.is_string())
+    { ep_ = jsp; throw EXP(Jnode::expected_valid_label); }
+   if(skip_blanks_(jsp) != LBL_SPR)
+    { ep_ = jsp; throw EXP(Jnode::missing_label_separator); }
+   span.labels.push_back(intern_(label));
+   ++jsp;
+  }
+  span.values.emplace_back();
+  parse_(span.values.back(), jsp);
+  if(span.values.back().type() == Jnode::Neither)
+   { ep_ = jsp; throw EXP(Jnode::expected_json_value); }
+  skip_blanks_(jsp);
+  if(jsp == span.end) return;
+  if(*jsp != JSN_ASPR)
+   { ep_ = jsp; throw EXP(Jnode::missed_prior_enumeration); }
+ }
+}
+
+
+void Json::defer_iterable_(Jnode & node, const char * &jsp) {
+ // keep iterable's raw json in the node (parsed once accessed): the json is validated here,
+ // unless it's known to be valid already (i.e. when a deferred iterable is materialized)
+ static const Events none;
+ auto sp = jsp;
+ if(vld_) parse_event_(none, jsp);
+ else jsp = skip_iterable_(jsp);
+ memcpy(node.text_(jsp - sp), sp, jsp - sp);
+ node.lazy_ = true;
+}
+
+
+const char * Json::skip_iterable_(const char * jsp) {
+ // return pointer past the (valid) iterable at jsp
+ size_t depth = 0;
+ do
+  switch(*jsp++) {
+   case JSN_STRQ:
+        while(*(jsp = skip_plain_chars_(jsp, JSN_STRQ, JSN_STRQ)) != JSN_STRQ)
+         jsp += *jsp == CHR_QUOT? 2: 1;
+        ++jsp;
+        break;
+   case JSN_OBJ_OPN: case JSN_ARY_OPN: ++depth; break;
+   case JSN_OBJ_CLS: case JSN_ARY_CLS: --depth; break;
+  }
+ while(depth > 0);
+ return jsp;
+}
+
+
+void Jnode::materialize_(void) {
+ // parse deferred children of the iterable (a single level, nested iterables are deferred)
+ Text * raw = txp_;
+ tx_ = 0;
+ lazy_ = false;
+
+ Json parser;
+ Symtab st;
+ parser.st_ = &st;
+ parser.lzy_ = true;
+ parser.vld_ = false;                                           // validated when deferred
+ const char * jsp = raw->str;
+ try { parser.parse_(*this, jsp); }
+ catch(...) { free_(raw); throw; }
+ free_(raw);
 }
 
 
-void Json::parse_(Jnode & node, std::string::const_iterator &jsp) {
+void Json::parse_(Jnode & node, const char * &jsp) {
  // parse JSON from string (unicode UTF-8 compliant)
  skip_blanks_(jsp);
  node.type_ = classify_jnode_(jsp);
 
  DBG(4) {                                                       // print currently parsed point
    const char* pfx{"parsing point ->"};
-   std::string str{&*jsp};
+   std::string str = pe_ == nullptr? std::string{jsp}: std::string{jsp, pe_};
    if(utf8_adjusted(0, str) > (DBG_WIDTH-sizeof(pfx))) {
     str = str.erase(byte_offset(str, DBG_WIDTH - sizeof(pfx) - 3));
     str += "...";
@@ -2226,46 +3037,53 @@ void Json::parse_(Jnode & node, std::string::const_iterator &jsp) {
  if(node.type_ == Jnode::Neither) return;
  DBG(5) DOUT() << "classified as: " << ENUMS(Jnode::Jtype, node.type()) << std::endl;
 
+ if(lzy_ and node.type_ <= Jnode::Array) {                      // lazy: only the topmost iterable
+  if(dfr_) return defer_iterable_(node, jsp);                   // is parsed, nested are deferred
+  GUARD(dfr_)
+  dfr_ = true;
+  if(node.type_ == Jnode::Object) parse_object_(node, ++jsp);
+  else parse_array_(node, ++jsp);
+  return;
+ }
+
  switch(node.type()) {
   case Jnode::Object: parse_object_(node, ++jsp); break;        // skip '{' with ++jsp
   case Jnode::Array: parse_array_(node, ++jsp); break;          // skip '[' with ++jsp
   case Jnode::String: parse_string_(node, ++jsp); break;        // skip '"' with ++jsp
   case Jnode::Number: parse_number_(node, jsp); break;
   case Jnode::Bool: parse_bool_(node, jsp); break;
-  case Jnode::Null: jsp += 4; break;                            // leave node blank, skip "null"
+  case Jnode::Null: node.drop_text_(); jsp += 4; break;         // leave node blank, skip "null"
   default: break;                                               // covering warning of the compiler
  }
 }
 
 
-void Json::parse_bool_(Jnode & node, std::string::const_iterator &jsp) {
+void Json::parse_bool_(Jnode & node, const char * &jsp) {
  // Parse first character of lexeme ([tT] or [fF])
- node.value_ = toupper(*jsp);                                   // i.e. store either 'T' or 'F'
- if(node.value_.front() == CHR_FALSE) ++jsp;
+ node.bul_(toupper(*jsp) == CHR_TRUE);
+ if(not node.ni_) ++jsp;
  jsp += 4;
 }
 
 
-void Json::parse_string_(Jnode & node, std::string::const_iterator &jsp) {
+void Json::parse_string_(Jnode & node, const char * &jsp) {
  // parse string value - from `"` till `"'
  auto sp = jsp;                                                 // copy, for a work-around
  auto ep = find_delimiter_(JSN_STRQ, jsp);
- node.value_ = std::string{sp, ep};                             // work around gnu's compiler bug
- //node.value_ = std::string{jsp, find_delimiter_('"', jsp)};   // this is broken in linux gnu c++
+ node.str_(sp, ep - sp);
  ++jsp;
 }
 
 
-void Json::parse_number_(Jnode & node, std::string::const_iterator &jsp) {
+void Json::parse_number_(Jnode & node, const char * &jsp) {
  // parse number, as per JSON number definition
  auto sp = jsp;                                                 // copy, for a work-around
  auto ep = validate_number_(jsp);
- node.value_ = std::string{sp, ep};                             // work around gnu's compiler bug
- //node.value_ = std::string{jsp, validate_number_(jsp)};       // this is broken in linux gnu c++
+ node.num_(sp, ep);                                             // keep binary value along
 }
 
 
-void Json::parse_array_(Jnode & node, std::string::const_iterator &jsp) {
+void Json::parse_array_(Jnode & node, const char * &jsp) {
  // parse elements of JSON Array (recursively)
  for(bool comma_read = false; true;) {
   Jnode child;
@@ -2285,25 +3103,26 @@ void Json::parse_array_(Jnode & node, std::string::const_iterator &jsp) {
   if(not comma_read and node.has_children())                    // e.g.: [ "abc" 3.14 ]
    { ep_ = jsp; throw EXP(Jnode::missed_prior_enumeration); }
 
-  node.children_().emplace(node.next_key_(), std::move(child));
+  node.children_unpinned_().append(std::move(child));
   comma_read = false;
  }
 }
 
 
-void Json::parse_object_(Jnode & node, std::string::const_iterator &jsp) {
+void Json::parse_object_(Jnode & node, const char * &jsp) {
  // parse elements of JSON Object (recursively)
+ Jnode label;                                                   // (label's buffer is reused)
  for(bool comma_read = false; true;) {
   skip_blanks_(jsp);
   auto lsp = jsp;                                               // label's begin pointer
 
-  Jnode label;
   parse_(label, jsp);                                           // must be a string (label)
   if(not label.is_string()) {
    if(label.type() == Jnode::Neither) {                         // parsing of label failed
     if(*jsp == JSN_OBJ_CLS) {
      if(node.empty()) { ++jsp; return; }                        // empty object: { }
-     if(not comma_read) { ++jsp; return; }                      // end of object: ..."last" }
+     if(not comma_read)                                         // end of object: ..."last" }
+      { node.children_unpinned_().sort(); ++jsp; return; }
     }
     if(*jsp == JSN_ASPR)                                        // == ','
      if(not comma_read and node.has_children())
@@ -2323,23 +3142,162 @@ void Json::parse_object_(Jnode & node, std::string::const_iterator &jsp) {
   if(not comma_read and node.has_children())                    // e.g.: [ "abc" 3.14 ]
    { ep_ = jsp; throw EXP(Jnode::missed_prior_enumeration); }
 
-  node.children_().emplace(std::move(label.str()), std::move(child));
+  node.children_unpinned_().append(intern_(label), std::move(child)); // sorted at the end
+  comma_read = false;
+ }
+}
+
+
+Jnode::Jtype Json::parse_event_(const Events & ev, const char * &jsp) {
+ // parse JSON value calling events, mirrors parse_(), returns parsed type
+ skip_blanks_(jsp);
+ auto jt = classify_jnode_(jsp);
+
+ switch(jt) {
+  case Jnode::Object:
+        if(ev.begin_object) ev.begin_object();
+        parse_object_events_(ev, ++jsp);                        // skip '{' with ++jsp
+        if(ev.end_object) ev.end_object();
+        break;
+  case Jnode::Array:
+        if(ev.begin_array) ev.begin_array();
+        parse_array_events_(ev, ++jsp);                         // skip '[' with ++jsp
+        if(ev.end_array) ev.end_array();
+        break;
+  case Jnode::String: {
+        auto sp = ++jsp;                                        // skip '"' with ++jsp
+        auto ep = find_delimiter_(JSN_STRQ, jsp);
+        ++jsp;
+        if(ev.string) ev.string(evs_.assign(sp, ep));           // (copy only if requested)
+        break;
+       }
+  case Jnode::Number: {
+        auto sp = jsp;
+        auto ep = validate_number_(jsp);
+        if(ev.number) ev.number(evs_.assign(sp, ep));
+        break;
+       }
+  case Jnode::Bool: {
+        bool val = toupper(*jsp) == CHR_TRUE;
+        jsp += val? 4: 5;
+        if(ev.boolean) ev.boolean(val);
+        break;
+       }
+  case Jnode::Null:
+        jsp += 4;                                               // skip "null"
+        if(ev.null) ev.null();
+        break;
+  default: break;                                               // covering warning of the compiler
+ }
+ return jt;
+}
+
+
+void Json::parse_array_events_(const Events & ev, const char * &jsp) {
+ // parse elements of JSON Array calling events, mirrors parse_array_()
+ for(bool comma_read = false, has_children = false; true;) {
+  if(parse_event_(ev, jsp) == Jnode::Neither) {
+   if(*jsp == JSN_ARY_CLS)
+    if(not has_children or not comma_read) { ++jsp; return; }   // empty or end of array
+   if(*jsp == JSN_ASPR)                                         // == ','
+    if(not comma_read and has_children)
+     { ++jsp; comma_read = true; continue; }                    // interleaving comma
+   ep_ = jsp; throw EXP(Jnode::expected_json_value);            // e.g.: "[ , ...", or "[ 123,, ]"
+  }
+  if(not comma_read and has_children)                           // e.g.: [ "abc" 3.14 ]
+   { ep_ = jsp; throw EXP(Jnode::missed_prior_enumeration); }
+  has_children = true;
+  comma_read = false;
+  ++cnt_;
+ }
+}
+
+
+void Json::parse_object_events_(const Events & ev, const char * &jsp) {
+ // parse elements of JSON Object calling events, mirrors parse_object_()
+ static const Events none;                                      // labels are parsed quietly
+ std::vector<Clabel> * lv{nullptr};                             // labels (when counting)
+ if(cnt_dup_) {
+  if(cld_ == clv_.size()) clv_.emplace_back();
+  lv = &clv_[cld_++];
+  lv->clear();
+ }
+
+ for(bool comma_read = false, has_children = false; true;) {
+  skip_blanks_(jsp);
+  auto lsp = jsp;                                               // label's begin pointer
+
+  auto lt = parse_event_(none, jsp);                            // must be a string (label)
+  if(lt != Jnode::String) {
+   if(lt == Jnode::Neither) {                                   // parsing of label failed
+    if(*jsp == JSN_OBJ_CLS)
+     if(not has_children or not comma_read)                     // empty or end of object
+      { ++jsp; if(lv != nullptr) discount_duplicates_(*lv); return; }
+    if(*jsp == JSN_ASPR)                                        // == ','
+     if(not comma_read and has_children)
+      { ++jsp; comma_read = true; continue; }                   // interleaving comma
+   }
+   ep_ = lsp; throw EXP(Jnode::expected_valid_label);
+  }
+  auto lep = jsp - 1;                                           // label's closing quote
+  if(ev.label) ev.label(evs_.assign(lsp + 1, lep));             // label w/o quotes
+
+  if(skip_blanks_(jsp) != LBL_SPR)                              // label was read, expecting ':'
+   { ep_ = jsp; throw EXP(Jnode::missing_label_separator); }
+
+  size_t cnt = cnt_;
+  if(parse_event_(ev, ++jsp) == Jnode::Neither)                 // after 'label:' there must follow
+   { ep_ = jsp; throw EXP(Jnode::expected_json_value); }        // a valid JSON value
+
+  if(not comma_read and has_children)                           // e.g.: [ "abc" 3.14 ]
+   { ep_ = jsp; throw EXP(Jnode::missed_prior_enumeration); }
+  has_children = true;
   comma_read = false;
+  ++cnt_;
+  if(lv != nullptr) lv->push_back(Clabel{lsp + 1, lep, cnt_ - cnt});
  }
 }
 
 
-std::string::const_iterator & Json::find_delimiter_(char c, std::string::const_iterator & jsp) {
+void Json::discount_duplicates_(std::vector<Clabel> & lv) {
+ // the tree keeps only the first of duplicate labels in an object, thus when counting,
+ // sizes of values of other duplicates are discounted
+ --cld_;
+ if(lv.size() < 2) return;
+ std::sort(lv.begin(), lv.end(), [](const Clabel & l, const Clabel & r) {
+                                  int c = std::memcmp(l.begin, r.begin, std::min(l.end - l.begin,
+                                                                                  r.end - r.begin));
+                                  if(c != 0) return c < 0;
+                                  if(l.end - l.begin != r.end - r.begin)
+                                   return l.end - l.begin < r.end - r.begin;
+                                  return l.begin < r.begin;     // (first occurrence first)
+                                 });
+ for(size_t i = 1; i < lv.size(); ++i)
+  if(lv[i].end - lv[i].begin == lv[i-1].end - lv[i-1].begin and
+     std::memcmp(lv[i].begin, lv[i-1].begin, lv[i].end - lv[i].begin) == 0)
+   cnt_ -= lv[i].size;
+}
+
+
+
+const char * & Json::find_delimiter_(char c, const char * & jsp) {
  // find next occurrence of character (actually it's used only to find `"')
- while(*jsp != c) {
-  if(*jsp AMONG(CHR_NULL, CHR_EOL, CHR_RTRN))                   // JSON string does not support
+ if(six_ != nullptr and c == JSN_STRQ) {                        // indexed: closing quote is
+  const char * np = six_->next(jsp);                            // the next indexed position
+  if(np != nullptr and np != pe_ and *np == JSN_STRQ and six_->clean(jsp, np))
+   return jsp = np;
+ }                                                              // otherwise scan to get the error
+
+ char slash = jsn_fbdn_[0] == '/'? '/': c;                      // '/' is special only if quoted
+ while(is_end_(jsp = skip_plain_chars_(jsp, c, slash, pe_)) or *jsp != c) {
+  if(is_end_(jsp) or *jsp AMONG(CHR_EOL, CHR_RTRN))             // JSON string does not support
    { ep_ = jsp; throw EXP(Jnode::unexpected_end_of_line); }     // multiline, hence throwing
   if(strchr(jsn_fbdn_, *jsp) != nullptr)                        // i.e. found illegal JSON control
    { ep_ = jsp; throw EXP(Jnode::unquoted_character); }
 
   if(*jsp == CHR_QUOT) {
    ++jsp;                                                       // skip presumably quoted char
-   if(*jsp == CHR_NULL)                                         // found end of string after '\'
+   if(is_end_(jsp))                                             // found end of string after '\'
     { ep_ = jsp; throw EXP(Jnode::unexpected_end_of_line); }
    if(strchr(jsn_qtd_, *jsp) == nullptr)                        // it's not JSON char quotation
     { ep_ = jsp; throw EXP(Jnode::unexpected_character_escape); }
@@ -2350,58 +3308,111 @@ std::string::const_iterator & Json::find_delimiter_(char c, std::string::const_i
 }
 
 
-std::string::const_iterator & Json::validate_number_(std::string::const_iterator & jsp) {
+OVERREAD_SAFE
+const char * Json::skip_plain_chars_(const char * jsp, char c, char s, const char * end) {
+ // return pointer to the first char requiring attention of find_delimiter_: either of
+ // c, s, '\\', or a control char (NUL incl.), or end (if given). 16 chars are checked at
+ // once with SSE2; loads are aligned, hence never cross a page boundary past the terminating
+ // NUL (or past the end)
+ #ifdef __SSE2__
+  const char * bp = jsp - reinterpret_cast<uintptr_t>(jsp) % 16;
+  const __m128i vc = _mm_set1_epi8(c), vs = _mm_set1_epi8(s),
+                vq = _mm_set1_epi8(CHR_QUOT), vl = _mm_set1_epi8(' ' - 1);
+  unsigned msk = ~0U << (jsp - bp);                             // ignore chars prior jsp
+  for(; true; bp += 16, msk = ~0U) {
+   if(end != nullptr and bp >= end) return end;
+   __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(bp));
+   __m128i sp = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, vc), _mm_cmpeq_epi8(v, vs)),
+                             _mm_or_si128(_mm_cmpeq_epi8(v, vq),   // ctrl: v <= 0x1F (unsigned)
+                                          _mm_cmpeq_epi8(_mm_min_epu8(v, vl), v)));
+   msk &= _mm_movemask_epi8(sp);
+   if(msk != 0) {
+    const char * fp = bp + __builtin_ctz(msk);
+    return end != nullptr and fp > end? end: fp;
+   }
+  }
+ #else
+  while(jsp != end and *jsp != c and *jsp != s and *jsp != CHR_QUOT and
+        static_cast<uint8_t>(*jsp) >= ' ')
+   ++jsp;
+  return jsp;
+ #endif
+}
+
+
+const char * & Json::validate_number_(const char * & jsp) {
  // wrapper for static json_number_definition()
- if(json_number_definition(jsp) != Jnode::Number)               // failed to convert
+ if(json_number_definition(jsp, pe_) != Jnode::Number)          // failed to convert
   { ep_ = jsp; throw EXP(Jnode::invalid_number); }
  return jsp;
 }
 
 
-Jnode::Jtype Json::json_number_definition(std::string::const_iterator & jsp) {
- // conform JSON's definition of a number
- if(*jsp == JSN_NUMM) ++jsp;                                    // == '-'
- if(not isdigit(*jsp)) return Jnode::Neither;                   // digit must follow '-' sign
+Jnode::Jtype Json::json_number_definition(std::string::const_iterator & jsi) {
+ // string iterator adapter for json_number_definition
+ const char * jsp = &*jsi;
+ auto jt = json_number_definition(jsp);
+ jsi += jsp - &*jsi;
+ return jt;
+}
+
+
+Jnode::Jtype Json::json_number_definition(const char * & jsp, const char * end) {
+ // conform JSON's definition of a number; input is bounded by end (if given)
+ auto is = [&jsp, end](char c) { return jsp != end and *jsp == c; };
+ auto is_digit = [&jsp, end](void) { return jsp != end and isdigit(*jsp); };
+
+ if(is(JSN_NUMM)) ++jsp;                                        // == '-'
+ if(not is_digit()) return Jnode::Neither;                      // digit must follow '-' sign
  if(*jsp > '0')
-  while(isdigit(*jsp)) ++jsp;
+  while(is_digit()) ++jsp;
  else                                                           // next could be only [.eE] or end
   ++jsp;                                                        // skip leading 0
  // here it could be either of [.eE] or end
- if(*jsp == JSN_NUMD) {                                         // == '.'
-  if(not isdigit(*++jsp)) return Jnode::Neither;                // digit must follow '.'
-  while(isdigit(*jsp)) ++jsp;
+ if(is(JSN_NUMD)) {                                             // == '.'
+  ++jsp;
+  if(not is_digit()) return Jnode::Neither;                     // digit must follow '.'
+  while(is_digit()) ++jsp;
  }
  // here could be [eE] or end
- if(*jsp AMONG('e', 'E')) {
+ if(is('e') or is('E')) {
   ++jsp;                                                        // skip [eE]
-  if(*jsp AMONG(JSN_NUMP, JSN_NUMM)) ++jsp;                     // skip [+-]
-  if(not isdigit(*jsp)) return Jnode::Neither;                  // digit must follow [eE][+/]
-  while(isdigit(*jsp)) ++jsp;
+  if(is(JSN_NUMP) or is(JSN_NUMM)) ++jsp;                       // skip [+-]
+  if(not is_digit()) return Jnode::Neither;                     // digit must follow [eE][+/]
+  while(is_digit()) ++jsp;
  }
  return Jnode::Number;
 }
 
 
-Jnode::Jtype Json::classify_jnode_(std::string::const_iterator & jsp) {
+Jnode::Jtype Json::classify_jnode_(const char * & jsp) {
  // classify returns either of the Jtypes, or Neither
- // it does not move the pointer
+ // it does not move the pointer (which must be within the input)
  if(*jsp == JSN_OBJ_OPN) return Jnode::Object;
  if(*jsp == JSN_ARY_OPN) return Jnode::Array;
  if(*jsp == JSN_STRQ) return Jnode::String;
- if(isdigit(*jsp) or (*jsp == JSN_NUMM and isdigit(*(jsp+1)))) return Jnode::Number;
-
- const char * str = &*jsp;
- if(std::strncmp(str, STR_TRUE, sizeof(STR_TRUE)-1) == 0) return Jnode::Bool;
- if(std::strncmp(str, STR_FALSE, sizeof(STR_FALSE)-1) == 0) return Jnode::Bool;
- if(std::strncmp(str, STR_NULL, sizeof(STR_NULL)-1) == 0) return Jnode::Null;
+ if(isdigit(*jsp) or (*jsp == JSN_NUMM and jsp + 1 != pe_ and isdigit(*(jsp+1))))
+  return Jnode::Number;
+
+ size_t left = pe_ == nullptr? sizeof(STR_FALSE): pe_ - jsp;    // (strncmp stops at NUL anyway)
+ auto is_literal = [jsp, left](const char * lit, size_t len)
+                    { return left >= len and std::strncmp(jsp, lit, len) == 0; };
+ if(is_literal(STR_TRUE, sizeof(STR_TRUE)-1)) return Jnode::Bool;
+ if(is_literal(STR_FALSE, sizeof(STR_FALSE)-1)) return Jnode::Bool;
+ if(is_literal(STR_NULL, sizeof(STR_NULL)-1)) return Jnode::Null;
  return Jnode::Neither;
 }
 
 
-char Json::skip_blanks_(std::string::const_iterator & jsp) {
+char Json::skip_blanks_(const char * & jsp) {
  // skip_blanks_() sets pointer to the first a non-blank character
- while(*jsp >= 0 and *jsp <= ' ') {                             // '*jsp >= 0' to support UTF-8
-  if(*jsp == CHR_NULL)
+ if(six_ != nullptr and jsp != pe_ and *jsp > 0 and *jsp <= ' ') { // indexed: first non-blank
+  const char * np = six_->next(jsp);                            // past blank(s) is always indexed
+  if(np != nullptr) jsp = np;
+ }
+
+ while(jsp == pe_ or (*jsp >= 0 and *jsp <= ' ')) {             // '*jsp >= 0' to support UTF-8
+  if(is_end_(jsp))
    { ep_ = jsp; throw EXP(Jnode::unexpected_end_of_string); }
   ++jsp;
  }
@@ -2501,52 +3512,142 @@ Json::iterator Json::walk(const std::string & wstr, CacheState action) {
 }
 
 
-std::string Json::unquote_str(std::string && src) const {
- // unquote JSON source string as per JSON quotation.
- // even though it looks static, it's best to keep it in-class, due to throwing mechanism
- std::stringstream ss;
- size_t start=0;
- for(size_t end = src.find('\\', start);
-     end != std::string::npos;
-     end = src.find('\\', start)) {
-  char qc = src[++end];                                         // quoted character
-  if(end >= src.size())                                         // i.e. line ending "...\"
+Json & Json::clear_cache(const iterator & it) {
+ // drop cache of searches, which a change of the node pointed by it could affect:
+ // searches off the node itself and off its parents; searches off the node's
+ // descendants are dropped once walked again (see is_origin_())
+ uncache_(&root());
+ for(auto & itr: it.pv_)
+  if(itr.jnp != nullptr) uncache_(itr.jnp);
+ return *this;
+}
+
+
+Jnode::Footprint Json::footprint(void) const {
+ // memory used by JSON, its search cache and namespace: nodes shared by the cache or
+ // namespace with JSON (copy-on-write) are accounted once - within JSON
+ Jnode::Footprint fp;
+ std::unordered_set<const void *> seen;
+ root().footprint_(fp, seen);
+ fp.ns = footprint_(jns_, seen);
+ for(auto & entry: sc_) {
+  fp.cache += RBT_NODE + sizeof(entry) + entry.KEY.origin.capacity() * sizeof(Itr) +
+              entry.VALUE.capacity() * sizeof(CacheEntry);
+  for(auto & ce: entry.VALUE)
+   fp.cache += ce.pv.capacity() * sizeof(Itr) + footprint_(ce.ns, seen);
+ }
+ return fp;
+}
+
+
+size_t Json::footprint_(const map_jn & ns, std::unordered_set<const void *> & seen) {
+ // memory used by a namespace: map's nodes, labels and values
+ size_t bytes = 0;
+ for(auto & entry: ns) {
+  Jnode::Footprint fp;
+  entry.VALUE.footprint_(fp, seen);
+  bytes += RBT_NODE + sizeof(entry) - sizeof(Jnode) + fp.total();
+  if(seen.insert(&entry.KEY.str()).second) bytes += entry.KEY.footprint();
+ }
+ return bytes;
+}
+
+
+std::string & Json::unquote_str(const std::string & src, std::string & dst) const {
+ // unquote JSON string src into dst (reusable buffer) as per JSON quotation, \uXXXX are
+ // translated into UTF-8. Even though it looks static, it's best to keep it in-class, due
+ // to throwing mechanism
+ dst.clear();
+ dst.reserve(src.size());
+ const char * sp = src.data(), * end = sp + src.size();
+ for(const char * ep;
+     (ep = static_cast<const char*>(memchr(sp, CHR_QUOT, end - sp))) != nullptr;
+     sp = ep) {                                                 // memchr is vectorized in libc
+  dst.append(sp, ep);
+  if(++ep == end)                                               // i.e. line ending "...\"
    throw EXP(Jnode::unexpected_end_of_quotation);
-  const char * ptr = strchr(jsn_qtd_, qc);                      // #define JSN_QTD "/\"\\bfnrtu"
+  const char * ptr = *ep == CHR_NULL? nullptr: strchr(jsn_qtd_, *ep);
   if(ptr == nullptr)                                            // i.e other (non-Json) char quoted
    throw EXP(Jnode::unexpected_quotation);
-  src[end-1] = '\0';
-  ss << src.data() + start << (qc == 'u'? "\\": "") << JSN_TRL[ptr - jsn_qtd_];
-  start = ++end;
+  if(*ep == 'u') ep = unquote_u_(ep + 1, end, dst);
+  else { dst += JSN_TRL[ptr - jsn_qtd_]; ++ep; }
+ }
+ return dst.append(sp, end);
+}
+
+
+const char * Json::unquote_u_(const char * sp, const char * end, std::string & dst) {
+ // translate XXXX of \uXXXX (sp points past 'u') into UTF-8, return pointer past translated
+ // chars: surrogate pairs are joined, lone surrogates become U+FFFD, while non-hex XXXX
+ // are left verbatim
+ auto hex4 = [end](const char * p) {
+  long cp{0};
+  if(end - p < 4) return -1L;
+  for(int i = 0; i < 4; ++i, ++p) {
+   int x = isdigit(*p)? *p - '0': isxdigit(*p)? (*p | 0x20) - 'a' + 10: -1;
+   if(x < 0) return -1L;
+   cp = cp << 4 | x;
+  }
+  return cp;
+ };
+
+ long cp = hex4(sp);
+ if(cp < 0) { dst += CHR_QUOT; dst += 'u'; return sp; }
+ sp += 4;
+ if(cp >= 0xD800 and cp < 0xDC00) {                             // high surrogate, low must follow
+  long lo = end - sp >= 2 and sp[0] == CHR_QUOT and sp[1] == 'u'? hex4(sp + 2): -1;
+  if(lo >= 0xDC00 and lo < 0xE000)
+   { cp = 0x10000 + ((cp - 0xD800) << 10) + (lo - 0xDC00); sp += 6; }
+  else cp = 0xFFFD;
+ }
+ else if(cp >= 0xDC00 and cp < 0xE000) cp = 0xFFFD;
+
+ if(cp < 0x80) dst += static_cast<char>(cp);
+ else if(cp < 0x800)
+  { dst += static_cast<char>(0xC0 | cp >> 6); dst += static_cast<char>(0x80 | (cp & 0x3F)); }
+ else if(cp < 0x10000) {
+  dst += static_cast<char>(0xE0 | cp >> 12);
+  dst += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+  dst += static_cast<char>(0x80 | (cp & 0x3F));
  }
- ss << src.c_str() + start;
- return ss.str();
+ else {
+  dst += static_cast<char>(0xF0 | cp >> 18);
+  dst += static_cast<char>(0x80 | (cp >> 12 & 0x3F));
+  dst += static_cast<char>(0x80 | (cp >> 6 & 0x3F));
+  dst += static_cast<char>(0x80 | (cp & 0x3F));
+ }
+ return sp;
 }
 
 
-std::string Json::inquote_str(std::string && src) const {
- // quote quotation marks and back slashes only, as src is expected to be a valid JSON string
- // because of unquote_str(), keeping this in-class defined, though it's entirely static
- std::stringstream ss;
- size_t start=0;
- for(size_t end{ src.find_first_of("\"\\", start) };
-     end != std::string::npos;
-     end = src.find_first_of("\"\\", start)) {
-  char chr = src[end];
-  src[end] = '\0';
-  ss << src.data() + start << '\\' << chr;
-  start = end + 1;
+std::string & Json::inquote_str(const std::string & src, std::string & dst) const {
+ // quote src into dst (reusable buffer) as per JSON quotation: quotation marks, back
+ // slashes and control chars (and solidus, if quoted) are quoted; return dst
+ dst.clear();
+ dst.reserve(src.size() + src.size() / 8);
+ char slash = is_solidus_quoted()? '/': JSN_STRQ;
+ const char * sp = src.data(), * end = sp + src.size();
+ for(const char * ep; (ep = skip_plain_chars_(sp, JSN_STRQ, slash, end)) != end; sp = ep + 1) {
+  dst.append(sp, ep);                                           // (skip_plain_chars_ is SSE2)
+  dst += CHR_QUOT;
+  const char * ptr = *ep == CHR_NULL? nullptr: strchr(JSN_TRL, *ep);
+  if(ptr != nullptr) { dst += JSN_QTD[ptr - JSN_TRL]; continue; }
+  const char * hex = "0123456789abcdef";                        // other control chars: \\u00XX
+  dst += "u00";
+  dst += hex[static_cast<uint8_t>(*ep) >> 4];
+  dst += hex[*ep & 0xF];
  }
- ss << src.c_str() + start;
- return ss.str();
+ return dst.append(sp, end);
 }
 
 
 void Json::compile_walk_(const std::string & wstr, iterator & it) const {
  // parse walk string and compile all parts for ws_;
  parse_lexemes_(wstr, it);
- for(auto & walk_step: it.walk_path_())
+ for(auto & walk_step: it.walk_path_()) {
   parse_subscript_type_(walk_step);                             // fix textual offset
+  walk_step.symbols.assign(walk_step.stripped.begin(), walk_step.stripped.end());
+ }
 }
 
 
@@ -2851,7 +3952,7 @@ bool Json::iterator::is_nested(iterator & it) const {
  if(pv_.back().jit == jp_->end_())                              // end() does not nest
   return false;
  for(size_t i = 0; i<pv_.size() and i<it.pv_.size(); ++i)
-  if(pv_[i].lbl != it.pv_[i].lbl)
+  if(pv_[i].jnp != it.pv_[i].jnp)
    return false;
  return true;
 }
@@ -2861,8 +3962,18 @@ bool Json::iterator::is_valid_(Jnode & jn, size_t idx) const {
  // check if all labels in path-vector are present
  if(idx >= pv_.size())                                          // no more pv_ idx to check
   return true;                                                  // all checked, return true then
- auto it = jn.children_().find(pv_[idx].lbl);                   // first try by label, if found
- if(it != jn.children_().end() and &it->VALUE == pv_[idx].jnp)  // then validate by Jnode addr
+ auto & children = jn.children_();
+ if(children.holds(pv_[idx].jit, pv_[idx].epoch))               // nothing erased there since
+  return is_valid_(pv_[idx].jit->VALUE, idx+1);
+ if(children.is_indexed()) {                                    // array: children only shift to
+  for(size_t i = std::min(pv_[idx].idx + 1, children.size()); i-- > 0;)   // the front, hence
+   if(&children.nth(i)->VALUE == pv_[idx].jnp)                  // look up Jnode addr from idx
+    return is_valid_(children.nth(i)->VALUE, idx+1);            // downwards
+  return false;
+ }
+ if(pv_[idx].lbl.is_null()) return false;                       // it was an array's child
+ auto it = children.find(pv_[idx].lbl);                         // first try by label, if found
+ if(it != children.end() and &it->VALUE == pv_[idx].jnp)        // then validate by Jnode addr
   return is_valid_(it->VALUE, idx+1);                           // check the rest of the tree
  return false;
 }
@@ -2901,7 +4012,8 @@ void Json::iterator::show_built_pv_(std::ostream &out) const {
  out << "built path vector:";
  for(auto &it: pv_)
   out << (&it == &pv_.front()? " ":"-> ")
-      << (it.jit == json().end_()? "(end)": it.lbl);
+      << (it.jit == json().end_()? "(end)":
+          it.jit.is_indexed()? std::to_string(it.idx): it.lbl.str());
  out << std::endl;
 }
 
@@ -2947,8 +4059,7 @@ void Json::iterator::walk_step_(size_t wsi, Jnode *jn) {        // wsi: walk-ste
          auto & parent = pv_.size() == 1? json().root(): pv_[pv_.size()-2].jit->VALUE;
          json().jns_[ws.stripped[0]] = parent.type_ == Jnode::Object?
                                        Jnode{ pv_.back().jit->KEY }:
-                                       Jnode{ static_cast<double>(
-                                              std::stol(pv_.back().jit->KEY, nullptr, 16)) };
+                                       Jnode{ static_cast<double>(pv_.back().jit.index()) };
          DBG(json(), 3) DOUT(json()) << "saved label into namespace: '"
                                      << ws.stripped[0] << "': "
                                      << json().jns_[ws.stripped[0]] << std::endl;
@@ -2972,57 +4083,13 @@ void Json::iterator::walk_numeric_offset_(size_t wsi, Jnode *jn) {
   return pv_.resize(-ws.offset <= static_cast<long>(pv_.size())? pv_.size() + ws.offset: 0);
 
  // [0], [+1], [..:..] etc
- size_t node_size = jn->children_().size();
+ size_t node_size = jn->children();
  size_t offset = normalize_(ws.offset, jn);
  if(ws.type == WalkStep::range_walk) ws.offset = offset;        // ws iterable, require normalizing
  if(offset >= node_size or offset >= normalize_(ws.tail, jn))   // beyond children's size/tail
   return pv_.emplace_back(json().end_(), true);
 
- if(ws.type == WalkStep::static_select and jn->is_array())      // [N] - subscript array
-  return pv_.emplace_back(jn->iterator_by_idx_(offset));
-
- auto it = build_cache_(jn, wsi);
-
- DBG(json(), 1) DOUT(json()) << "found cached idx " << offset << std::endl;
- pv_.emplace_back(it);
-}
-
-
-Json::iter_jn Json::iterator::build_cache_(Jnode *jn, size_t wsi) {
- // build cache for subscripts
- auto &ws = ws_[wsi];
- auto & cache_map = json().sc_;                                 // all caches map
- SearchCacheKey skey{jn, ws};                                   // prepare a search key
- auto found_cache = cache_map.find(skey);
- bool build_cache = found_cache == cache_map.end() or           // cache does not exist, or
-                    (found_cache->KEY.ws.type != WalkStep::cache_complete and   // not cached yet
-                     static_cast<size_t>(ws.offset) >= found_cache->VALUE.front().pv.size());
- if(build_cache) {
-  DBG(json(), 1) DOUT(json()) << "building cache for [" << wsi << "] " << skey << std::endl;
-  auto & cache = found_cache == cache_map.end()? cache_map[skey]: found_cache->VALUE;
-  if(cache.empty())
-   { cache.resize(1); cache.front().pv.emplace_back(jn->children_().begin()); }
-
-  size_t size = ws.type == WalkStep::static_select? ws.offset: normalize_(ws.tail, jn) - 1;
-  for(size_t i = cache.front().pv.size(); i <= size; ++i) {
-   auto it = cache.front().pv.back().jit;
-   cache.front().pv.emplace_back(++it);
-  }
-  if(cache.front().pv.size() == jn->children_().size()) {
-   // indication that cache is complete is stored in the SearchCacheKey:
-   skey.ws.type = WalkStep::cache_complete;                     // indicate cache completed
-   auto pc = move(cache);                                       // move/preserve the cache
-   json().sc_.erase(skey);                                      // erase old skey
-   json().sc_[skey] = move(pc);                                 // create new one
-  }
-
-  found_cache = cache_map.find(skey);
-  DBG(json(), 1)
-   DOUT(json()) << "built cache size: " << found_cache->VALUE.front().pv.size()
-                << ", cache status: " << ENUMS(WalkStep::WalkStepType, found_cache->KEY.ws.type)
-                << std::endl;
- }
- return found_cache->VALUE.front().pv[ws.offset].jit;
+ pv_.emplace_back(jn->iterator_by_idx_(offset));                // subscripted directly
 }
 
 
@@ -3077,11 +4144,17 @@ void Json::iterator::walk_search_(size_t wsi, Jnode *jn) {
  auto & cache_map = json().sc_;                                 // all caches map
  SearchCacheKey skey{jn, ws};                                   // prepare a search key
  auto found_cache = cache_map.find(skey);
+ if(found_cache != cache_map.end() and not is_origin_(found_cache->KEY.origin)) {
+  DBG(json(), 1) DOUT(json()) << "dropping stale cache for [" << wsi << "] " << skey << std::endl;
+  cache_map.erase(found_cache);                                 // jn is not a cached node
+  found_cache = cache_map.end();
+ }
  bool build_cache = found_cache == cache_map.end() or           // cache does not exist, or
                     (found_cache->KEY.ws.type != WalkStep::cache_complete and   // not cached yet
                      offset >= found_cache->VALUE.size());
  if(build_cache) {
   DBG(json(), 1) DOUT(json()) << "building cache for [" << wsi << "] " << skey << std::endl;
+  skey.origin = pv_;                                            // walked path leads to jn
   auto & cache = found_cache == cache_map.end()? cache_map[skey]: found_cache->VALUE;
   research_(jn, wsi, &cache, &skey);                            // build cache
   found_cache = cache_map.find(skey);
@@ -3119,8 +4192,10 @@ void Json::iterator::research_(Jnode *jn, size_t wsi,
                << ", descend: " << ENUMS(SearchType, ws.is_recursive()? recursive: non_recursive)
                << ", caching? " << (vpv? "yes": "no") << std::endl;
 
+ size_t path_from = pv_.size();
  bool found = re_search_(jn, ws, nullptr, i, cache_from, non_recursive, vpv);
  if(vpv) vpv->pop_back();                                       // last entry is redundant
+ else if(found) pin_path_(pv_, path_from);                      // found path is handed out
 
  if(not found) {                                                // entire Jnode was searched
   if(vpv == nullptr)                                            // indicate |nothing found|
@@ -3134,7 +4209,7 @@ void Json::iterator::research_(Jnode *jn, size_t wsi,
 }
 
 
-bool Json::iterator::re_search_(Jnode *jn, WalkStep &ws, const char *lbl, long &i,
+bool Json::iterator::re_search_(Jnode *jn, WalkStep &ws, const Symbol *lbl, long &i,
                                 long cf, SearchType pass, std::vector<Json::CacheEntry> * vpv) {
  // build cache, return true/false if match found (i'th instance), otherwise false
  // returning false globally indicates entire json has been searched up
@@ -3155,8 +4230,9 @@ bool Json::iterator::re_search_(Jnode *jn, WalkStep &ws, const char *lbl, long &
  if(pass == recursive and ws.is_non_recursive())                // >..<: further recursion denied
   return false;
 
- long idx = 0;
- for(auto it = jn->children_().begin(); it != jn->children_().end(); ++it) {
+ long idx = 0;                                                  // children are pinned only if
+ auto & children = jn->children_unpinned_();                    // a found path goes through
+ for(auto it = children.begin(); it != children.end(); ++it) {
   if(vpv) vpv->back().pv.emplace_back(it); else pv_.emplace_back(it);
 
   long j = 0;                                                   // to be used in lieu of i
@@ -3165,7 +4241,7 @@ bool Json::iterator::re_search_(Jnode *jn, WalkStep &ws, const char *lbl, long &
       build_cache_(ws.is_qnt_relative()? j: i, ws.is_qnt_relative()? j: cf, vpv))
     return true;
 
-  if(re_search_(&it->VALUE, ws, jn->is_object()? it->KEY.c_str(): nullptr, i, cf, recursive, vpv))
+  if(re_search_(&it->VALUE, ws, jn->is_object()? &it->KEY: nullptr, i, cf, recursive, vpv))
    return true;
 
   if(vpv) vpv->back().pv.pop_back(); else pv_.pop_back();
@@ -3184,16 +4260,37 @@ bool Json::iterator::build_cache_(long &i, long cf, std::vector<Json::CacheEntry
  if(vpv != nullptr) {                                           // build cache then
   vpv->push_back(vpv->back());                                  // cache-in (built cache actually)
   vpv->back().ns.clear();                                       // this is required aft REGEX match
+  pin_path_(vpv->back().pv, 0);
  }
  return i < 0;
 }
 
 
-bool Json::iterator::match_iterable_(Jnode *jn, const char *lbl, const WalkStep &ws) {
+void Json::iterator::pin_path_(path_vector & pv, size_t from) {
+ // children along a found path are never shared (the path's iterators are handed out)
+ for(size_t i = from; i < pv.size(); ++i) {
+  Jnode::desc_jn::pin(pv[i].jit);
+  pv[i].epoch = Jnode::desc_jn::epoch(pv[i].jit);               // epoch is given upon pinning
+ }
+}
+
+
+bool Json::iterator::is_origin_(const path_vector & origin) const {
+ // check if the walked path (pv_) is the origin of a cached search: nodes along the
+ // path are same and their containers held no removal since (see pin_path_())
+ if(origin.size() != pv_.size()) return false;
+ for(size_t i = 0; i < pv_.size(); ++i)
+  if(origin[i].jnp != pv_[i].jnp or
+     origin[i].epoch == 0 or origin[i].epoch != pv_[i].epoch) return false;
+ return true;
+}
+
+
+bool Json::iterator::match_iterable_(Jnode *jn, const Symbol *lbl, const WalkStep &ws) {
  // match any iterable suffixes and attached label (if any)
  // assert(jn->is_iterable())
  if(ws.stripped.size() > 1)                                     // there's an attached search label
-  if(lbl == nullptr or ws.stripped.back() != lbl )              // there's no label
+  if(lbl == nullptr or *lbl != ws.symbols.back())                     // there's no label
    return false;                                                // label does not match
 
  if(ws.jsearch == search_from_ns) {                             // facilitating <..>s
@@ -3219,11 +4316,11 @@ bool Json::iterator::match_iterable_(Jnode *jn, const char *lbl, const WalkStep
 }
 
 
-bool Json::iterator::atomic_match_(const Jnode *jn, const char *lbl,
+bool Json::iterator::atomic_match_(const Jnode *jn, const Symbol *lbl,
                                    const WalkStep &ws, map_jn * nsp) {
  // see if string/number/bool/null value matches
  if(ws.stripped.size() > 1)                                     // label attached: try matching
-  if(lbl == nullptr or ws.stripped.back() != lbl) return false; // no label, or not matching
+  if(lbl == nullptr or *lbl != ws.symbols.back()) return false;       // no label, or not matching
 
  auto user_json_ptr = &ws.user_json;                            // set user_json from walkstep
  switch (ws.jsearch) {
@@ -3266,11 +4363,11 @@ bool Json::iterator::string_match_(const Jnode *jn, const WalkStep &ws, map_jn *
  // match numbers and strings also using RE
  switch(ws.jsearch) {
   case digital_match:
-        return jn->is_number() and jn->val() == ws.stripped.front();
+        return jn->is_number() and jn->text_is_(ws.stripped.front());
   case Digital_regex:
         return jn->is_number() and regex_match_(jn->val(), ws, nsp);
   case regular_match:
-        return jn->is_string() and jn->val() == ws.stripped.front();
+        return jn->is_string() and jn->text_is_(ws.stripped.front());
   case Regex_search:
         return jn->is_string() and regex_match_(jn->val(), ws, nsp);
   default:                                                      // should never reach here
@@ -3289,10 +4386,10 @@ bool Json::iterator::regex_match_(const std::string &val, const WalkStep &ws, ma
 }
 
 
-bool Json::iterator::label_match_(map_jn::iterator jit, const Jnode *jn, long idx,
+bool Json::iterator::label_match_(iter_jn jit, const Jnode *jn, long idx,
                                   WalkStep &ws, map_jn * nsp) const {
  // return true if instance i of label (l,t) matches, false otherwise
- static map_jn::iterator found;
+ map_jn::iterator found;
  if(ws.jsearch == tag_from_ns) {                                // facilitate <..>t / >..<t
   found = json().jns_.find(ws.stripped[0]);                     // see if value was preserved
   if(found == json().jns_.end())
@@ -3307,7 +4404,7 @@ bool Json::iterator::label_match_(map_jn::iterator jit, const Jnode *jn, long id
   if(ws.jsearch == tag_from_ns)                                 // <..>t
    return jn->is_object()? jit->KEY == found->VALUE.val(): false;
   if(ws.jsearch == label_match)                                 // <..>l
-   return jit->KEY == ws.stripped.front();
+   return jit->KEY == ws.symbols.front();
   return regex_match_(jit->KEY, ws, nsp);                       // <..>L
  }
 
@@ -3315,7 +4412,7 @@ bool Json::iterator::label_match_(map_jn::iterator jit, const Jnode *jn, long id
   return regex_match_(jit->KEY, ws, nsp);
                                                                 // >..<: quant. is relative here
  long ws_off = ws.load_offset(json()),
-      jn_size = static_cast<long>(jn->children_().size());
+      jn_size = static_cast<long>(jn->children());
 
  if(ws.jsearch == tag_from_ns and found->VALUE.is_number()) {   // >..<t is numeric value
   long idx_val = found->VALUE.num();                            // resolve >..<t value in NS
@@ -3329,15 +4426,15 @@ bool Json::iterator::label_match_(map_jn::iterator jit, const Jnode *jn, long id
                                        found->VALUE.val(): ws.stripped.front());
  if(found_lbl == jn->children_().end()) return false;           // >..<t/l value's not found
  if(idx == 0) {                                                 // first run:
-  long idx_val = std::distance(jn->children_().begin(), found_lbl);
+  long idx_val = found_lbl.index();
   if(ws_off < -idx_val)                                         // offset too low?
    ws.head = ws.offset = ws_off = -idx_val;                     // fix too low offset
  }
- if(idx - ws_off < 0) return false;                             // outside of jn's children
- std::advance(jit, -ws_off);
+ if(idx - ws_off < 0 or idx - ws_off >= jn_size) return false;  // outside of jn's children
+ const auto & lbl = jn->children_().nth(idx - ws_off)->KEY;
  if(ws.jsearch == tag_from_ns)                                  // facilitate >..<t
-  return jit->KEY == found->VALUE.val();                        // OBJ: return label match
- return jit->KEY == ws.stripped.front();                        // facilitate >..<l
+  return lbl == found->VALUE.val();                             // OBJ: return label match
+ return lbl == ws.symbols.front();                              // facilitate >..<l
 }
 
 
@@ -3428,7 +4525,7 @@ void Json::iterator::purge_ns_(const std::string &pfx) {
 }
 
 
-void Json::iterator::lbl_callback_(const char *label,
+void Json::iterator::lbl_callback_(const std::string &label,
                                    const std::vector<Json::CacheEntry> *vpv) {
  // invoke callback attached to the label (if there's one)
  if(json().lbl_callbacks().count(label) == 0) return;           // label not registered?
@@ -3460,11 +4557,11 @@ void Json::iterator::wlk_callback_(const Jnode *jnp) {
 }
 
 
-void Json::iterator::dmx_callback_(const Jnode *jn, const char *lbl,
+void Json::iterator::dmx_callback_(const Jnode *jn, const Symbol *lbl,
                                    const std::vector<Json::CacheEntry> *vpv) {
  // demux callbacks
  if(json().is_engaged(walk_callback)) wlk_callback_(jn);
- if(lbl and json().is_engaged(label_callback)) lbl_callback_(lbl, vpv);
+ if(lbl and json().is_engaged(label_callback)) lbl_callback_(*lbl, vpv);
 }
 
 
@@ -3594,13 +4691,14 @@ size_t Json::byte_offset(const std::string &jsrc, size_t utf8_offset) {
 
 
 #undef DBG_WIDTH
-#undef ARRAY_LMT
 #undef KEY
 #undef VALUE
 #undef GLAMBDA
 
 #undef PRINT_PRT
 #undef PRINT_RAW
+#undef TXT_INL
+#undef TXT_OUT
 #undef CHR_TRUE
 #undef CHR_FALSE
 #undef CHR_NULL
@@ -3630,7 +4728,9 @@ size_t Json::byte_offset(const std::string &jsrc, size_t utf8_offset) {
 #undef PFX_WFR
 #undef PFX_WFL
 #undef RNG_SPR
-#undef IDX_FIL
+#undef JSN_PSPAN
+#undef HSH_PRIME
+#undef RBT_NODE
 
 #undef JSN_FBDN
 #undef JSN_QTD
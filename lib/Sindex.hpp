@@ -0,0 +1,240 @@
+/*
+ * structural index of a JSON text (stage 1 of the two-stage parsing)
+ *
+ * the input is scanned in 64-byte blocks: for every block bitmasks of quotes,
+ * back-slashes and blanks are built (SSE2 when available, a scalar loop otherwise),
+ * escaped characters are resolved with carry-propagating arithmetic and strings are
+ * located with a prefix-xor over unescaped quotes. Following positions are indexed:
+ *  - unescaped quotes (i.e. beginning and end of every string)
+ *  - every non-blank character outside of strings which follows a blank
+ *  - terminating NUL
+ * also, positions within strings which would make the scalar scanner throw (forbidden
+ * control chars, bad escapes) are recorded as anomalies.
+ *
+ * the index is built lazily (a chunk at a time), thus it never reads much past the
+ * point where the parser stops (i.e. it's suitable for a stream of JSONs)
+ *
+ * SYNOPSIS:
+ *  Sindex si;
+ *  si.reset(jsp, JSN_FBDN, JSN_QTD);
+ *
+ *  const char * np = si.next(jsp);     // next indexed position at or past jsp
+ *  if(*np == '"' and si.clean(jsp, np))
+ *   ...                                // string [jsp, np) requires no further checks
+ *
+ * CAUTION: the input must be NUL terminated, or bounded by the end given in reset()
+ *          (then the end is indexed as if it was the terminator); blocks are read aligned,
+ *          hence no read ever crosses a page boundary past the terminator (or the end)
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstring>              // strchr
+#include "extensions.hpp"
+#ifdef __SSE2__
+# include <emmintrin.h>
+#endif
+
+
+#define SIX_BLOCK 64                                            // bytes per block (bits in mask)
+#define SIX_CHUNK 64                                            // blocks indexed per refill
+
+
+
+
+
+class Sindex {
+ public:
+
+    Sindex &            reset(const char * jsp, const char * fbdn, const char * qtd,
+                              const char * end = nullptr);
+    const char *        next(const char * jsp);
+    bool                clean(const char * from, const char * to);
+
+ private:
+    void                index_chunk_(void);
+    void                index_block_(const char * bp, uint64_t lead);
+    static void         classify_(const char * bp, uint64_t & quote, uint64_t & bslash,
+                                  uint64_t & blank, uint64_t & ctrl, uint64_t & nul);
+    uint64_t            escaped_(uint64_t bslash);
+    static uint64_t     prefix_xor_(uint64_t x);
+
+    std::vector<const char *>
+                        ix_;                                    // structural index
+    size_t              ic_{0};                                 // index cursor
+    std::vector<const char *>
+                        av_;                                    // anomalies
+    size_t              ac_{0};                                 // anomalies cursor
+    const char *        bp_{nullptr};                           // next block to index
+    const char *        end_{nullptr};                          // input end (if not NUL bound)
+    uint64_t            lead_{0};                               // bits to skip in 1st block
+    bool                done_{true};                            // terminator indexed
+    uint64_t            esc_{0};                                // carry: next char is escaped
+    uint64_t            ins_{0};                                // carry: inside string (all 1s)
+    uint64_t            blk_{1};                                // carry: previous char is blank
+    char                fbdn_[256];                             // forbidden chars in strings
+    char                qtd_[256];                              // allowed quoted chars
+};
+
+
+
+Sindex & Sindex::reset(const char * jsp, const char * fbdn, const char * qtd,
+                       const char * end) {
+ // start indexing from jsp, fbdn and qtd are same as Json's jsn_fbdn_ and jsn_qtd_
+ std::memset(fbdn_, 0, sizeof(fbdn_));
+ std::memset(qtd_, 0, sizeof(qtd_));
+ for(; *fbdn != '\0'; ++fbdn) fbdn_[static_cast<uint8_t>(*fbdn)] = 1;
+ for(; *qtd != '\0'; ++qtd) qtd_[static_cast<uint8_t>(*qtd)] = 1;
+
+ ix_.clear(); av_.clear();
+ ic_ = ac_ = 0;
+ bp_ = jsp - reinterpret_cast<uintptr_t>(jsp) % SIX_BLOCK;      // aligned block beginning
+ lead_ = jsp - bp_;
+ end_ = end;
+ done_ = false;
+ esc_ = ins_ = 0;
+ blk_ = 1;                                                      // jsp is preceded by a "blank"
+ return *this;
+}
+
+
+
+const char * Sindex::next(const char * jsp) {
+ // return first indexed position at or past jsp (NUL terminator is always indexed)
+ while(true) {
+  while(ic_ < ix_.size() and ix_[ic_] < jsp) ++ic_;
+  if(ic_ < ix_.size()) return ix_[ic_];
+  if(done_) return nullptr;
+  index_chunk_();
+ }
+}
+
+
+
+bool Sindex::clean(const char * from, const char * to) {
+ // check there are no recorded anomalies in [from, to): range must be indexed already
+ while(ac_ < av_.size() and av_[ac_] < from) ++ac_;
+ return ac_ == av_.size() or av_[ac_] >= to;
+}
+
+
+
+void Sindex::index_chunk_(void) {
+ // index next chunk of blocks, drop already consumed indices
+ ix_.erase(ix_.begin(), ix_.begin() + ic_);
+ ic_ = 0;
+ for(int i = 0; i < SIX_CHUNK and not done_; ++i, bp_ += SIX_BLOCK)
+  { index_block_(bp_, lead_); lead_ = 0; }
+}
+
+
+
+void Sindex::index_block_(const char * bp, uint64_t lead) {
+ // build masks for the block and extract indices from them
+ uint64_t quote{0}, bslash{0}, blank{0}, ctrl{0}, nul{0};
+ if(end_ == nullptr or bp < end_)                               // never read a block past end
+  classify_(bp, quote, bslash, blank, ctrl, nul);
+ if(end_ != nullptr and bp + SIX_BLOCK > end_)                  // the end is a terminator
+  nul |= 1ULL << (end_ - bp);
+
+ uint64_t valid = ~0ULL << lead;                                // drop leading bytes (1st block)
+ uint64_t body = valid;                                         // bytes short of the terminator
+ if(nul & valid) {                                              // drop trailing bytes past NUL
+  nul &= valid;
+  nul &= -nul;                                                  // keep lowest NUL only
+  valid &= nul | (nul - 1);
+  body = valid & (nul - 1);                                     // (the end could be any byte)
+  done_ = true;
+ }
+ else nul = 0;
+ quote &= body; bslash &= body; ctrl &= body;
+ blank |= ~valid;                                               // out of range bytes are blanks
+
+ uint64_t escaped = escaped_(bslash);
+ quote &= ~escaped;
+ uint64_t ins = prefix_xor_(quote) ^ ins_;                      // set from opening quote up to
+ ins_ = static_cast<uint64_t>(static_cast<int64_t>(ins) >> 63); // (excluding) closing quote
+ uint64_t follows_blank = blank << 1 | blk_;
+ blk_ = blank >> 63;
+
+ uint64_t idx = quote | nul | (~blank & ~ins & follows_blank);
+ for(; idx != 0; idx &= idx - 1)
+  ix_.push_back(bp + __builtin_ctzll(idx));
+
+ uint64_t susp = ins & (escaped | ctrl);                        // suspicious chars within strings
+ for(; susp != 0; susp &= susp - 1) {
+  int bit = __builtin_ctzll(susp);
+  uint8_t c = bp + bit == end_? '\0': bp[bit];                 // the end is never read
+  if((escaped >> bit & 1)? not qtd_[c]: fbdn_[c])
+   av_.push_back(bp + bit);
+ }
+}
+
+
+
+OVERREAD_SAFE
+void Sindex::classify_(const char * bp, uint64_t & quote, uint64_t & bslash,
+                       uint64_t & blank, uint64_t & ctrl, uint64_t & nul) {
+ // build per-byte masks of a 64-byte (aligned) block:
+ // - blank: 0x01..0x20 (as per Json::skip_blanks_)
+ // - ctrl: 0x01..0x1F and '/' (candidates for JSN_FBDN)
+ quote = bslash = blank = ctrl = nul = 0;
+ #ifdef __SSE2__
+  auto mask = [](__m128i m) { return static_cast<uint64_t>(_mm_movemask_epi8(m)); };
+  const __m128i zero = _mm_setzero_si128();
+  for(int i = 0; i < SIX_BLOCK / 16; ++i) {
+   __m128i v = _mm_load_si128(reinterpret_cast<const __m128i*>(bp) + i);
+   __m128i pos = _mm_cmpgt_epi8(v, zero);                       // signed: excludes UTF-8 bytes
+   int sh = i * 16;
+   quote |= mask(_mm_cmpeq_epi8(v, _mm_set1_epi8('"'))) << sh;
+   bslash |= mask(_mm_cmpeq_epi8(v, _mm_set1_epi8('\\'))) << sh;
+   nul |= mask(_mm_cmpeq_epi8(v, zero)) << sh;
+   blank |= mask(_mm_and_si128(pos, _mm_cmplt_epi8(v, _mm_set1_epi8(' ' + 1)))) << sh;
+   ctrl |= mask(_mm_or_si128(_mm_and_si128(pos, _mm_cmplt_epi8(v, _mm_set1_epi8(' '))),
+                             _mm_cmpeq_epi8(v, _mm_set1_epi8('/')))) << sh;
+  }
+ #else
+  for(int i = 0; i < SIX_BLOCK; ++i) {
+   char c = bp[i];
+   uint64_t bit = 1ULL << i;
+   if(c == '"') quote |= bit;
+   else if(c == '\\') bslash |= bit;
+   else if(c == '\0') nul |= bit;
+   else if(c == '/') ctrl |= bit;
+   else if(c > 0 and c <= ' ') { blank |= bit; if(c != ' ') ctrl |= bit; }
+  }
+ #endif
+}
+
+
+
+uint64_t Sindex::escaped_(uint64_t bslash) {
+ // return mask of characters escaped by odd-length back-slash sequences
+ const uint64_t even_bits = 0x5555555555555555ULL;
+ bslash &= ~esc_;                                               // escaped by previous block
+ uint64_t follows_escape = bslash << 1 | esc_;
+ uint64_t odd_starts = bslash & ~even_bits & ~follows_escape;
+ unsigned long long even_seqs;
+ esc_ = __builtin_uaddll_overflow(odd_starts, bslash, &even_seqs);
+ uint64_t invert_mask = even_seqs << 1;
+ return (even_bits ^ invert_mask) & follows_escape;
+}
+
+
+
+uint64_t Sindex::prefix_xor_(uint64_t x) {
+ // bit n of result is xor of all bits 0..n of x
+ x ^= x << 1;
+ x ^= x << 2;
+ x ^= x << 4;
+ x ^= x << 8;
+ x ^= x << 16;
+ x ^= x << 32;
+ return x;
+}
+
+#undef SIX_BLOCK
+#undef SIX_CHUNK
+
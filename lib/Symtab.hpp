@@ -0,0 +1,232 @@
+/*
+ * interned labels of JSON objects
+ *
+ * Symbol is a handle to a shared immutable string (kept along with its hash): copies of
+ * a symbol share the string, hence equal symbols coming from the same table compare by
+ * pointer, while unequal ones mostly compare by hash. Symbols are reference counted
+ * (atomically: they could be copied and destroyed by any thread), symbol's string is
+ * allocated from the arena (see "Arena.hpp")
+ *
+ * Symbol converts into const std::string & implicitly and orders exactly as std::string
+ * does, so a std::map keyed by symbols (with transparent std::less<>) could be looked up
+ * by std::string directly
+ *
+ * a null symbol has no string at all (e.g. it's a key of an array element, see
+ * "Descendants.hpp"): it could be copied, tested (is_null()) and destroyed only
+ *
+ * Symtab is a table of symbols (e.g. parser's one, per a parsed JSON document): it hands
+ * out a same symbol for every same string
+ *
+ * SYNOPSIS:
+ *  Symtab st;
+ *  Symbol a = st.intern("label"), b = st.intern("label");
+ *  std::cout << (a.same(b) and a == "label") << std::endl;     // prints 1
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstring>              // memcmp
+#include <algorithm>            // std::max
+#include <ostream>
+#include "Arena.hpp"
+
+
+#define SYM_MINTAB 256                                          // min size of symbols table
+#define SYM_IMMORTAL (SIZE_MAX / 2)                             // refs of a never freed symbol
+
+
+
+
+
+class Symbol {
+    friend class Symtab;
+
+ public:
+                        Symbol(void): sp_{empty_()}             // DC
+                         { sp_->refs.fetch_add(1, std::memory_order_relaxed); }
+                        Symbol(const Symbol & s): sp_{s.sp_}    // CC
+                         { if(sp_) sp_->refs.fetch_add(1, std::memory_order_relaxed); }
+                        Symbol(Symbol && s): sp_{s.sp_}         // MC
+                         { s.sp_ = nullptr; }
+                        Symbol(std::string && s)                // standalone (non-interned)
+                         { size_t h = hash_(s); sp_ = make_(std::move(s), h); }
+                        Symbol(const std::string & s)
+                         { sp_ = make_(std::string{s}, hash_(s)); }
+                        Symbol(const char * s): Symbol{std::string{s}} {}
+                        Symbol(std::nullptr_t): sp_{nullptr} {} // null symbol (has no string)
+                       ~Symbol(void) { release_(); }
+
+    Symbol &            operator=(Symbol s)                     // CA, MA
+                         { std::swap(sp_, s.sp_); return *this; }
+
+                        operator const std::string &(void) const { return sp_->str; }
+    const std::string & str(void) const { return sp_->str; }
+    const char *        c_str(void) const { return sp_->str.c_str(); }
+    size_t              size(void) const { return sp_->str.size(); }
+    bool                empty(void) const { return sp_->str.empty(); }
+    size_t              hash(void) const { return sp_->hash; }
+    bool                same(const Symbol & s) const { return sp_ == s.sp_; }
+    bool                is_null(void) const { return sp_ == nullptr; }
+    size_t              footprint(void) const;                  // bytes used by shared string
+
+    bool                operator==(const Symbol & s) const
+                         { return sp_ == s.sp_ or (sp_->hash == s.sp_->hash and
+                                                   sp_->str == s.sp_->str); }
+    bool                operator!=(const Symbol & s) const { return not operator==(s); }
+    bool                operator<(const Symbol & s) const
+                         { return sp_ != s.sp_ and sp_->str < s.sp_->str; }
+
+    friend bool         operator==(const Symbol & l, const std::string & r)
+                         { return l.sp_->str == r; }
+    friend bool         operator==(const std::string & l, const Symbol & r)
+                         { return l == r.sp_->str; }
+    friend bool         operator==(const Symbol & l, const char * r)
+                         { return l.sp_->str == r; }
+    friend bool         operator!=(const Symbol & l, const std::string & r)
+                         { return l.sp_->str != r; }
+    friend bool         operator!=(const std::string & l, const Symbol & r)
+                         { return l != r.sp_->str; }
+    friend bool         operator!=(const Symbol & l, const char * r)
+                         { return l.sp_->str != r; }
+    friend bool         operator<(const Symbol & l, const std::string & r)
+                         { return l.sp_->str < r; }
+    friend bool         operator<(const std::string & l, const Symbol & r)
+                         { return l < r.sp_->str; }
+    friend bool         operator<(const Symbol & l, const char * r)
+                         { return l.sp_->str < r; }
+    friend bool         operator<(const char * l, const Symbol & r)
+                         { return l < r.sp_->str; }
+
+    friend std::ostream &
+                        operator<<(std::ostream & os, const Symbol & s)
+                         { return os << s.sp_->str; }
+
+    static size_t       hash_(const std::string & s) { return hash_(s.data(), s.size()); }
+    static size_t       hash_(const char * s, size_t n);
+
+ private:
+    struct Sym {
+        std::string     str;
+        size_t          hash;
+        std::atomic<size_t>
+                        refs;
+    };
+
+                        Symbol(Sym * sp): sp_{sp} {}            // adopting constructor
+
+    static Sym *        make_(std::string && s, size_t h);
+    static Sym *        empty_(void);
+    void                release_(void);
+
+    Sym *               sp_;
+};
+
+
+
+class Symtab {
+ public:
+    Symbol              intern(const std::string & s) { return intern(s.data(), s.size()); }
+    Symbol              intern(const char * s, size_t n);
+    void                clear(void) { tab_.clear(); cnt_ = 0; }
+    size_t              size(void) const { return cnt_; }
+
+ private:
+    void                grow_(void);
+
+    std::vector<Symbol> tab_;                                   // open addressing (linear)
+    size_t              cnt_{0};                                // symbols in table
+};
+
+
+
+Symbol::Sym * Symbol::make_(std::string && s, size_t h) {
+ // make a new symbol (with a single reference)
+ void * mem = Arena::allocate(sizeof(Sym), alignof(Sym));
+ return new(mem) Sym{std::move(s), h, {1}};
+}
+
+
+
+Symbol::Sym * Symbol::empty_(void) {
+ // symbol of an empty string is shared and never freed
+ static Sym * empty = new Sym{std::string{}, hash_(std::string{}), {SYM_IMMORTAL}};
+ return empty;
+}
+
+
+
+void Symbol::release_(void) {
+ // drop a reference, free symbol with the last one
+ if(sp_ != nullptr and sp_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+  sp_->~Sym();
+  Arena::deallocate(sp_);
+ }
+}
+
+
+
+size_t Symbol::footprint(void) const {
+ // memory used by symbol's string (shared by all copies), a short string is kept inline
+ if(sp_ == nullptr) return 0;
+ const char * data = sp_->str.data();
+ const char * self = reinterpret_cast<const char *>(&sp_->str);
+ bool inl = data >= self and data < self + sizeof(std::string);
+ return sizeof(Sym) + (inl? 0: sp_->str.capacity() + 1);
+}
+
+
+
+size_t Symbol::hash_(const char * s, size_t n) {
+ // FNV-1a
+ uint64_t h = 14695981039346656037ULL;
+ for(const char * e = s + n; s < e; ++s)
+  { h ^= static_cast<unsigned char>(*s); h *= 1099511628211ULL; }
+ return h;
+}
+
+
+
+Symbol Symtab::intern(const char * s, size_t n) {
+ // return a symbol for the string, add it to the table if it's not there yet
+ if(cnt_ * 2 >= tab_.size()) grow_();
+ size_t h = Symbol::hash_(s, n);
+ size_t mask = tab_.size() - 1;
+ for(size_t i = h & mask; true; i = (i + 1) & mask) {
+  Symbol & sym = tab_[i];
+  if(sym.sp_ == nullptr) {
+   sym.sp_ = Symbol::make_(std::string{s, n}, h);
+   ++cnt_;
+   return sym;
+  }
+  if(sym.sp_->hash == h and sym.sp_->str.size() == n and
+     std::memcmp(sym.sp_->str.data(), s, n) == 0)
+   return sym;
+ }
+}
+
+
+
+void Symtab::grow_(void) {
+ // double the table (re-hash symbols)
+ size_t size = std::max<size_t>(tab_.size() * 2, SYM_MINTAB);
+ std::vector<Symbol> tab;
+ tab.reserve(size);
+ for(size_t i = 0; i < size; ++i)
+  tab.push_back(Symbol{static_cast<Symbol::Sym*>(nullptr)});
+ size_t mask = size - 1;
+ for(auto & sym: tab_)
+  if(sym.sp_ != nullptr) {
+   size_t i = sym.sp_->hash & mask;
+   while(tab[i].sp_ != nullptr) i = (i + 1) & mask;
+   std::swap(tab[i].sp_, sym.sp_);
+  }
+ tab_.swap(tab);
+}
+
+#undef SYM_MINTAB
+#undef SYM_IMMORTAL
+
@@ -255,6 +255,13 @@ bool operator==(const std::string &a, std::vector<const char *> b) {
  */
 
 
+// aligned (SIMD) loads of a NUL terminated buffer may read bytes around the buffer
+// (but never past the page boundary), which is safe, though alerts sanitizers: mark
+// such functions with OVERREAD_SAFE to exempt them from instrumentation
+#define OVERREAD_SAFE __attribute__((no_sanitize_address, no_sanitize_thread))
+
+
+
 // There are 2 forms of GUARD: for a {single object} and for {getter, setter}
 // Forms demultiplexing occurs in __GUARD_CHOOSER__ macro, which results into
 // expanding __GUARD_1_ARG__ for the former case and into __GUARD_2_ARG__ for
@@ -317,6 +317,7 @@ class Getopt {
                              swap(l.cnt_, r.cnt_);
                              swap(l.go_, r.go_);
                             }
+        friend Getopt;
 
      public:
                             OptionsOrdered(void) = default;     // DC
@@ -364,6 +365,8 @@ class Getopt {
                              swap(l.prgname_, r.prgname_);
                              swap(l.om_, r.om_);
                              swap(l.ov_, r.ov_);
+                             l.rebind_();
+                             r.rebind_();
                             }
 
  public:
@@ -382,7 +385,13 @@ class Getopt {
 
 
                         Getopt(void) = default;             // DC
-                        Getopt(const Getopt &) = default;   // CC
+                        Getopt(const Getopt & go):          // CC
+                         exception_{go.exception_}, throwException_{go.throwException_},
+                         autohelp_{go.autohelp_}, variadic_{go.variadic_},
+                         argc_{go.argc_}, argv_{go.argv_}, prolog_{go.prolog_},
+                         epilog_{go.epilog_}, arguments_{go.arguments_},
+                         prgname_{go.prgname_}, om_{go.om_}, ov_{go.ov_}
+                         { rebind_(); }
                         Getopt(Getopt && go)                // MC
                          { swap(*this, go); }
     Getopt &            operator=(Getopt go)                // CA, MA
@@ -437,6 +446,7 @@ class Getopt {
 
  private:
     //void                update_order_(short option_id);
+    void                rebind_(void);
     void                parseInputArgs_(int argc, char *argv[], const std::string &fmt);
     void                processStandalone_(int argc, char *argv[]);
     void                usagePrintOptions_(std::stringstream &, int indent);
@@ -452,6 +462,14 @@ STRINGIFY(Getopt::ThrowReason, THROWREASON)
 
 
 
+void Getopt::rebind_(void) {
+ // point options (and their ordered records) back to this instance (after copy, swap)
+ for(auto & o: om_) o.second.go_ = this;
+ for(auto & o: ov_) o.go_ = this;
+}
+
+
+
 Option & Option::hit(void) {
  // record a hit (by virtue of pushing a value into order_ vector)
  // and update order of the option itself